@@ -2,14 +2,22 @@
 #ifndef SKETCH_MAIN_HEADER_HPP
 #define SKETCH_MAIN_HEADER_HPP
 
+#include <string>
 #include <string_view>
+#include <vector>
 
 #include <sketch/application.hpp>
+#include <sketch/layout_publisher.hpp>
 #include <sketch/window.hpp>
 
 namespace sk {
 
 window_t load_sketch(std::string_view filename);
+
+/* loads a batch of sketches, files they share through includes are read,
+ * parsed and evaluated only once
+ */
+std::vector<window_t> load_sketches(const std::vector<std::string>& filenames);
 }
 
 #endif // SKETCH_MAIN_HEADER_HPP
@@ -2,13 +2,65 @@
 #ifndef SK_APPLICATION_HPP
 #define SK_APPLICATION_HPP
 
+#include <memory>
+#include <string_view>
+#include <vector>
+
 #include <sketch/window.hpp>
 
+struct SDL_WindowEvent;
+
 namespace sk {
 
+namespace impl {
+class capture_pool_t;
+class event_player_t;
+class event_recorder_t;
+class frame_scheduler_t;
+class introspection_server_t;
+class job_system_t;
+class layout_engine_t;
+struct layout_follower_t;
+class metrics_t;
+class timer_wheel_t;
+class window_registry_t;
+}
+
 class application_t final {
-    std::vector<window_t> _windows;
-    bool                  _running = {true};
+    friend class window_t;
+
+    // windows go first on destruction, they cancel their timers
+    std::unique_ptr<impl::timer_wheel_t>     _timers;
+    std::unique_ptr<impl::frame_scheduler_t> _frames;
+    std::unique_ptr<impl::job_system_t>      _jobs; // started on first use
+    std::unique_ptr<impl::layout_engine_t>   _layout;
+    std::unique_ptr<impl::event_recorder_t>  _recorder;
+    std::unique_ptr<impl::event_player_t>    _player;
+    std::unique_ptr<impl::window_registry_t> _windows;
+    std::unique_ptr<impl::layout_follower_t> _follower;
+    std::vector<std::unique_ptr<window_t>>   _removed;
+    bool                                     _running = {true};
+
+    std::unique_ptr<impl::capture_pool_t> _captures; // created on first use
+
+    // the server reads the metrics until it's gone
+    std::unique_ptr<impl::metrics_t>              _metrics;
+    std::unique_ptr<impl::introspection_server_t> _introspection;
+
+    impl::job_system_t& jobs();
+    void                handle_events();
+    void                handle_window_event(window_t&, const SDL_WindowEvent&);
+    void                unthrottle(window_t&);
+    void                hover(window_t&, int x, int y);
+    void                schedule_frame(window_t&, std::chrono::nanoseconds);
+    std::size_t         service_frames(); // windows drawn
+    void                refresh_displays();
+    void                constrain(window_t&);
+    void                relayout();
+    void                follow_layout();
+    void                measure(window_t&); // for introspection, as SDL has it
+    bool                capture(
+        window_t&, capture_format_t, capture_handler_t&&); // see window_t
 
 public:
     application_t& operator=(const application_t&) = delete;
@@ -19,10 +71,51 @@ public:
     application_t();
     ~application_t();
 
-    void add(window_t&&);
+    window_handle_t add(window_t&&);
+
+    /* the window is hidden and stops receiving events and timers right away,
+     * then it's destroyed a few windows per loop iteration, so it may remove
+     * itself from its callbacks and closing many at once doesn't stall a
+     * frame; the application quits once the last window is removed
+     */
+    void remove(window_handle_t);
+
+    // lookups are constant time, nullptr if there's no such window
+    window_t* get(window_handle_t) const;
+    window_t* find(std::uint32_t sdl_window_id) const;
+    window_t* find(std::string_view title) const;
+
+    std::size_t size() const;
+
     int  run();
     void quit();
     bool is_running() const;
+
+    /* creates the windows a layout_publisher_t published to the segment and
+     * keeps them in line with whatever it publishes later: windows are
+     * matched by position, those whose title stays are constrained and get
+     * their elements anew, others are replaced; the segment has to exist,
+     * following another one replaces it
+     */
+    void follow(std::string_view segment);
+
+    /* serves metrics on a unix domain socket at path, from a thread of its
+     * own: window geometry, event and frame rates, fps and queue depths as a
+     * JSON snapshot, or a JSON line per frame; the loop only updates counters
+     * and never waits for a client, see introspection_server.hpp for the
+     * protocol
+     */
+    void introspect(std::string_view path);
+
+    // writes the input every window receives into a binary log
+    void record(std::string_view filename);
+
+    /* feeds a recorded log back at the given speed, prints reactor latency
+     * and frame time statistics and quits once the log is exhausted; windows
+     * are matched by their handle's slot, i.e. by the order they were added
+     * in as long as none was removed
+     */
+    void replay(std::string_view filename, double speed = 1.0);
 };
 }
 
@@ -0,0 +1,68 @@
+#pragma once
+#ifndef SK_CANVAS_HPP
+#define SK_CANVAS_HPP
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+struct SDL_Surface;
+struct SDL_Window;
+
+namespace sk {
+
+struct color_t {
+    std::uint8_t r = {0};
+    std::uint8_t g = {0};
+    std::uint8_t b = {0};
+    std::uint8_t a = {255};
+};
+
+struct rect_t {
+    int x = {0};
+    int y = {0};
+    int w = {0};
+    int h = {0};
+};
+
+/* software drawing surface of a window, for hosts without an accelerated
+ * renderer: it draws straight into the window surface with simd kernels
+ * picked at run time and keeps track of what it touched, present() then
+ * copies only those rectangles to the screen
+ *
+ * everything is clipped to the window, the surface has to be 32 bits per
+ * pixel with 8-bit channels, which is what window surfaces normally are
+ */
+class canvas_t final {
+    SDL_Window*         _window = {nullptr};
+    std::vector<rect_t> _touched;
+
+    SDL_Surface* surface();
+    template <typename FuncType>
+    void draw(const rect_t&, FuncType&& row);
+
+public:
+    explicit canvas_t(SDL_Window*);
+
+    int width();
+    int height();
+
+    // pixel value of the color in the surface format, e.g. for blit sources
+    std::uint32_t map(color_t);
+
+    void fill(const rect_t&, color_t);
+    void blend(const rect_t&, color_t); // by the alpha of the color
+    void outline(const rect_t&, color_t, int thickness = 1);
+
+    // pixels in the surface format, pitch is in pixels and defaults to width
+    void blit(
+        const rect_t&                   to,
+        std::span<const std::uint32_t> pixels,
+        int                             pitch = 0);
+
+    // updates the touched parts of the window on screen
+    void present();
+};
+}
+
+#endif // SK_CANVAS_HPP
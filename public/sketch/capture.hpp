@@ -0,0 +1,34 @@
+#pragma once
+#ifndef SK_CAPTURE_HPP
+#define SK_CAPTURE_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include <gsl/gsl>
+
+namespace sk {
+
+class window_t;
+
+enum class capture_format_t : std::uint8_t {
+    png, // uncompressed, stored deflate blocks
+    raw  // 8-bit rgba, rows top to bottom, no padding
+};
+
+// the contents of a window surface, encoded
+struct capture_t {
+    capture_format_t                      format = {capture_format_t::png};
+    int                                   width  = {0};
+    int                                   height = {0};
+    std::chrono::steady_clock::time_point taken; // when it was read back
+    std::vector<std::uint8_t>             data;
+};
+
+using capture_handler_t =
+    std::function<void(gsl::not_null<window_t*>, capture_t&&)>;
+}
+
+#endif // SK_CAPTURE_HPP
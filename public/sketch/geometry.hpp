@@ -0,0 +1,66 @@
+#pragma once
+#ifndef SK_GEOMETRY_HPP
+#define SK_GEOMETRY_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+namespace sk {
+
+/* single declarative coordinate or extent of a window, it's kept as written
+ * and resolved against the bounds of the window's display every time those
+ * change
+ */
+struct length_t {
+    enum class unit_t : std::uint8_t {
+        undefined, // extents fill the display, positions are up to the system
+        pixels,    // positions are relative to the display origin
+        fraction,  // of the display extent
+        full,      // whole display extent
+        centered   // positions only
+    };
+
+    unit_t unit   = {unit_t::undefined};
+    double value  = {0};
+    double offset = {0}; // pixels added to fractions, e.g. 50% - 20px
+
+    static constexpr length_t
+    pixels(std::size_t value)
+    {
+        return {unit_t::pixels, static_cast<double>(value)};
+    }
+
+    static constexpr length_t
+    fraction(double value, double offset = 0)
+    {
+        return {unit_t::fraction, value, offset};
+    }
+
+    static constexpr length_t
+    full()
+    {
+        return {unit_t::full, 0};
+    }
+
+    static constexpr length_t
+    centered()
+    {
+        return {unit_t::centered, 0};
+    }
+
+    bool operator==(const length_t&) const = default;
+};
+
+// window constraints, see window_t::geometry
+struct geometry_t {
+    length_t x;
+    length_t y;
+    length_t width;
+    length_t height;
+    int      display = {0};
+
+    bool operator==(const geometry_t&) const = default;
+};
+}
+
+#endif // SK_GEOMETRY_HPP
@@ -0,0 +1,145 @@
+#pragma once
+#ifndef SK_KEYBOARD_HPP
+#define SK_KEYBOARD_HPP
+
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#include <gsl/gsl>
+
+namespace sk {
+
+class application_t;
+class window_t;
+
+namespace impl {
+class chord_table_t;
+}
+
+// SDL scancodes, i.e. physical keys whatever the keyboard layout
+using scancode_t = std::uint16_t;
+
+// left and right modifier keys alike, locks aren't modifiers
+enum class modifiers_t : std::uint8_t {
+    none  = 0,
+    shift = 1u << 0u,
+    ctrl  = 1u << 1u,
+    alt   = 1u << 2u,
+    gui   = 1u << 3u
+};
+
+constexpr modifiers_t
+operator|(modifiers_t a, modifiers_t b)
+{
+    return static_cast<modifiers_t>(
+        static_cast<std::uint8_t>(a) | static_cast<std::uint8_t>(b));
+}
+
+constexpr modifiers_t
+operator&(modifiers_t a, modifiers_t b)
+{
+    return static_cast<modifiers_t>(
+        static_cast<std::uint8_t>(a) & static_cast<std::uint8_t>(b));
+}
+
+struct key_event_t {
+    scancode_t   scancode  = {0};
+    std::int32_t keycode   = {0}; // SDL keycode, depends on the layout
+    modifiers_t  modifiers = {modifiers_t::none};
+    bool         pressed   = {true};
+    bool         repeat    = {false}; // pressed and held
+};
+
+// a key pressed while exactly these modifiers are held, e.g. ctrl+shift+s
+struct chord_t {
+    modifiers_t modifiers = {modifiers_t::none};
+    scancode_t  scancode  = {0};
+
+    bool operator==(const chord_t&) const = default;
+};
+
+// generational, unbinding twice or after the slot was reused does nothing
+using binding_id_t = std::uint64_t;
+
+/* keyboard as a window sees it: which keys are down, one bit per scancode
+ * updated as events arrive, and shortcuts bound to chords
+ *
+ * bindings are compiled into a table indexed by chord before the first
+ * press after they changed, so a press costs a single lookup however many
+ * bindings there are; a press runs every binding of its chord, in the order
+ * they were bound, repeats and releases run none
+ *
+ * keys held when the window loses focus are released without key-up events
+ */
+class keyboard_t final {
+    friend class application_t;
+    friend class window_t;
+
+public:
+    static constexpr std::size_t scancodes = {512}; // SDL_NUM_SCANCODES
+
+    using handler_t = std::function<void(gsl::not_null<window_t*>)>;
+
+private:
+    struct binding_t {
+        chord_t       chord;
+        handler_t     handler;
+        std::uint64_t order      = {0}; // of binding
+        std::uint32_t generation = {0};
+        bool          bound      = {false};
+    };
+
+    std::array<std::uint64_t, scancodes / 64> _down      = {};
+    modifiers_t                               _modifiers = {modifiers_t::none};
+
+    // kept where they are, so that a handler may bind while it runs
+    std::deque<binding_t>      _bindings;
+    std::vector<std::uint32_t> _free; // slots, reused once compiled
+    std::vector<std::uint32_t> _unbound;
+    std::uint64_t              _order    = {0};
+    std::size_t                _bound    = {0};
+    bool                       _compiled = {true};
+
+    std::unique_ptr<impl::chord_table_t> _table;
+
+    window_t* _window = {nullptr};
+
+    binding_id_t add(const chord_t&, handler_t&&);
+    void         compile();
+
+    void update(const key_event_t&);
+    void release_all();
+
+    // runs the bindings of a press, returns how many ran
+    std::size_t dispatch(const key_event_t&);
+
+public:
+    keyboard_t& operator=(const keyboard_t&) = delete;
+    keyboard_t& operator=(keyboard_t&&) noexcept;
+    keyboard_t(const keyboard_t&) = delete;
+    keyboard_t(keyboard_t&&) noexcept;
+    keyboard_t();
+    ~keyboard_t();
+
+    bool        is_down(scancode_t) const;
+    modifiers_t modifiers() const; // of the last key event
+
+    template <typename FuncType>
+    binding_id_t
+    bind(const chord_t& chord, FuncType&& func)
+    {
+        static_assert(std::is_invocable_v<FuncType, gsl::not_null<window_t*>>);
+        return add(chord, handler_t(std::forward<FuncType>(func)));
+    }
+
+    bool        unbind(binding_id_t);
+    std::size_t bindings() const;
+};
+}
+
+#endif // SK_KEYBOARD_HPP
@@ -0,0 +1,47 @@
+#pragma once
+#ifndef SK_LAYOUT_PUBLISHER_HPP
+#define SK_LAYOUT_PUBLISHER_HPP
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace sk {
+
+namespace impl {
+class layout_segment_t;
+}
+
+/* parses sketches once for several processes: the windows they describe are
+ * published to a named shared memory segment, which applications map with
+ * application_t::follow to create the windows without parsing anything; the
+ * segment is removed along with the publisher, processes that follow it keep
+ * what they have
+ *
+ *     sk::layout_publisher_t publisher("sketch-wall");
+ *     publisher.publish({"left.sketch", "right.sketch"});
+ */
+class layout_publisher_t final {
+    std::unique_ptr<impl::layout_segment_t> _segment;
+
+public:
+    layout_publisher_t& operator=(const layout_publisher_t&) = delete;
+    layout_publisher_t(const layout_publisher_t&)            = delete;
+
+    explicit layout_publisher_t(std::string_view segment);
+    ~layout_publisher_t();
+
+    /* loads the sketches as load_sketches does, but creates no windows, and
+     * replaces whatever was published before; followers pick the change up
+     * on their own, returns the generation it's published as
+     */
+    std::uint64_t publish(const std::vector<std::string>& filenames);
+
+    // of the last publish, 0 before the first one
+    std::uint64_t generation() const;
+};
+}
+
+#endif // SK_LAYOUT_PUBLISHER_HPP
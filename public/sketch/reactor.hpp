@@ -4,11 +4,15 @@
 
 #include <cstdint>
 #include <functional>
+#include <string_view>
 #include <tuple>
 #include <type_traits>
 
 #include <gsl/gsl>
 
+#include <sketch/keyboard.hpp>
+#include <sketch/scene.hpp>
+
 namespace sk {
 
 class window_t;
@@ -19,10 +23,33 @@ class reactor_t final {
     std::function<void(gsl::not_null<window_t*>)> _on_draw;
     std::function<void(gsl::not_null<window_t*>)> _on_quit;
     std::function<void(gsl::not_null<window_t*>, std::size_t)> _on_keydown;
+    std::function<void(gsl::not_null<window_t*>, const key_event_t&)> _on_key;
+    std::function<void(gsl::not_null<window_t*>, std::string_view)> _on_text;
     std::function<void(
         gsl::not_null<window_t*>, const std::tuple<std::size_t, std::size_t>&)>
         _on_mouse_move;
 
+    // window lifecycle
+    std::function<void(gsl::not_null<window_t*>)> _on_close;
+    std::function<void(gsl::not_null<window_t*>)> _on_show;
+    std::function<void(gsl::not_null<window_t*>)> _on_hide;
+    std::function<void(gsl::not_null<window_t*>)> _on_minimize;
+    std::function<void(gsl::not_null<window_t*>)> _on_restore;
+    std::function<void(gsl::not_null<window_t*>)> _on_expose;
+    std::function<void(gsl::not_null<window_t*>, bool)> _on_focus;
+    std::function<void(
+        gsl::not_null<window_t*>, const std::tuple<std::size_t, std::size_t>&)>
+        _on_resize;
+
+    // scene elements under the mouse, see scene_t::hit_test
+    std::function<void(gsl::not_null<window_t*>, element_id_t)> _on_enter;
+    std::function<void(gsl::not_null<window_t*>, element_id_t)> _on_leave;
+    std::function<void(
+        gsl::not_null<window_t*>,
+        element_id_t,
+        const std::tuple<std::size_t, std::size_t>&)>
+        _on_hover;
+
     window_t* _window = {nullptr};
 
 public:
@@ -36,7 +63,20 @@ public:
     void on_draw();
     void on_quit();
     void on_keydown(std::size_t);
+    void on_key(const key_event_t&);
+    void on_text(std::string_view utf8);
     void on_mouse_move(const std::tuple<std::size_t, std::size_t>&);
+    void on_close();
+    void on_show();
+    void on_hide();
+    void on_minimize();
+    void on_restore();
+    void on_expose();
+    void on_focus(bool gained);
+    void on_resize(const std::tuple<std::size_t, std::size_t>&);
+    void on_enter(element_id_t);
+    void on_leave(element_id_t);
+    void on_hover(element_id_t, const std::tuple<std::size_t, std::size_t>&);
 
     template <typename FuncType>
     void
@@ -65,6 +105,30 @@ public:
         _on_keydown = std::forward<FuncType>(keydown_func);
     }
 
+    // presses, repeats and releases, see keyboard_t for the keys held down
+    template <typename FuncType>
+    void
+    set_on_key(FuncType&& key_func)
+    {
+        static_assert(
+            std::is_invocable_v<FuncType,
+                                gsl::not_null<window_t*>,
+                                const key_event_t&>);
+        _on_key = std::forward<FuncType>(key_func);
+    }
+
+    // text typed, as utf-8, composed by the system from key presses
+    template <typename FuncType>
+    void
+    set_on_text(FuncType&& text_func)
+    {
+        static_assert(
+            std::is_invocable_v<FuncType,
+                                gsl::not_null<window_t*>,
+                                std::string_view>);
+        _on_text = std::forward<FuncType>(text_func);
+    }
+
     template <typename FuncType>
     void
     set_on_mouse_move(FuncType&& mouse_move_func)
@@ -75,6 +139,108 @@ public:
                                 const std::tuple<std::size_t, std::size_t>&>);
         _on_mouse_move = std::forward<FuncType>(mouse_move_func);
     }
+
+    template <typename FuncType>
+    void
+    set_on_close(FuncType&& close_func)
+    {
+        static_assert(std::is_invocable_v<FuncType, gsl::not_null<window_t*>>);
+        _on_close = std::forward<FuncType>(close_func);
+    }
+
+    template <typename FuncType>
+    void
+    set_on_show(FuncType&& show_func)
+    {
+        static_assert(std::is_invocable_v<FuncType, gsl::not_null<window_t*>>);
+        _on_show = std::forward<FuncType>(show_func);
+    }
+
+    template <typename FuncType>
+    void
+    set_on_hide(FuncType&& hide_func)
+    {
+        static_assert(std::is_invocable_v<FuncType, gsl::not_null<window_t*>>);
+        _on_hide = std::forward<FuncType>(hide_func);
+    }
+
+    template <typename FuncType>
+    void
+    set_on_minimize(FuncType&& minimize_func)
+    {
+        static_assert(std::is_invocable_v<FuncType, gsl::not_null<window_t*>>);
+        _on_minimize = std::forward<FuncType>(minimize_func);
+    }
+
+    template <typename FuncType>
+    void
+    set_on_restore(FuncType&& restore_func)
+    {
+        static_assert(std::is_invocable_v<FuncType, gsl::not_null<window_t*>>);
+        _on_restore = std::forward<FuncType>(restore_func);
+    }
+
+    template <typename FuncType>
+    void
+    set_on_expose(FuncType&& expose_func)
+    {
+        static_assert(std::is_invocable_v<FuncType, gsl::not_null<window_t*>>);
+        _on_expose = std::forward<FuncType>(expose_func);
+    }
+
+    template <typename FuncType>
+    void
+    set_on_focus(FuncType&& focus_func)
+    {
+        static_assert(
+            std::is_invocable_v<FuncType, gsl::not_null<window_t*>, bool>);
+        _on_focus = std::forward<FuncType>(focus_func);
+    }
+
+    template <typename FuncType>
+    void
+    set_on_resize(FuncType&& resize_func)
+    {
+        static_assert(
+            std::is_invocable_v<FuncType,
+                                gsl::not_null<window_t*>,
+                                const std::tuple<std::size_t, std::size_t>&>);
+        _on_resize = std::forward<FuncType>(resize_func);
+    }
+
+    template <typename FuncType>
+    void
+    set_on_enter(FuncType&& enter_func)
+    {
+        static_assert(
+            std::is_invocable_v<FuncType,
+                                gsl::not_null<window_t*>,
+                                element_id_t>);
+        _on_enter = std::forward<FuncType>(enter_func);
+    }
+
+    template <typename FuncType>
+    void
+    set_on_leave(FuncType&& leave_func)
+    {
+        static_assert(
+            std::is_invocable_v<FuncType,
+                                gsl::not_null<window_t*>,
+                                element_id_t>);
+        _on_leave = std::forward<FuncType>(leave_func);
+    }
+
+    template <typename FuncType>
+    void
+    set_on_hover(FuncType&& hover_func)
+    {
+        static_assert(
+            std::is_invocable_v<FuncType,
+                                gsl::not_null<window_t*>,
+                                element_id_t,
+                                const std::tuple<std::size_t, std::size_t>&>);
+        _on_hover = std::forward<FuncType>(hover_func);
+    }
 };
 }
 
@@ -0,0 +1,110 @@
+#pragma once
+#ifndef SK_SCENE_HPP
+#define SK_SCENE_HPP
+
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <sketch/geometry.hpp>
+
+namespace sk {
+
+namespace impl {
+class hit_index_t;
+}
+
+using element_id_t = std::uint32_t;
+
+enum class element_kind_t : std::uint8_t { panel, label, rect };
+
+/* elements of a window as a flat structure of arrays rather than a tree of
+ * nodes: elements are stored in depth-first order, so every element comes
+ * after its parent and its descendants form a contiguous range right after
+ * it; layout is a single forward pass and everything that walks the scene
+ * walks contiguous memory
+ *
+ * element geometry uses the same units as windows, relative to the parent
+ * element or to the window for top-level elements, the display of the
+ * geometry is ignored; undefined positions are the parent origin
+ */
+class scene_t final {
+public:
+    static constexpr element_id_t npos = {UINT32_MAX};
+
+private:
+    // declared
+    std::vector<element_kind_t> _kinds;
+    std::vector<element_id_t>   _parents;
+    std::vector<element_id_t>   _ends; // one past the last descendant
+    std::vector<geometry_t>     _geometry;
+    std::vector<std::string>    _texts;
+
+    // resolved in window coordinates
+    std::vector<int> _x;
+    std::vector<int> _y;
+    std::vector<int> _w;
+    std::vector<int> _h;
+
+    int  _width  = {0};
+    int  _height = {0};
+    bool _dirty  = {false};
+
+    std::unique_ptr<impl::hit_index_t> _index;
+    bool                               _indexed = {false};
+
+public:
+    scene_t& operator=(const scene_t&) = delete;
+    scene_t& operator=(scene_t&&) noexcept;
+    scene_t(const scene_t&) = delete;
+    scene_t(scene_t&&) noexcept;
+    scene_t();
+    ~scene_t();
+
+    /* the parent has to be the last element added or one of its ancestors,
+     * i.e. elements are added depth-first
+     */
+    element_id_t add(
+        element_kind_t    kind,
+        element_id_t      parent,
+        const geometry_t& geometry,
+        std::string       text = {});
+    void clear();
+
+    std::size_t size() const;
+    bool        empty() const;
+
+    element_kind_t    kind(element_id_t) const;
+    element_id_t      parent(element_id_t) const;
+    element_id_t      end(element_id_t) const; // of the element's subtree
+    std::string_view  text(element_id_t) const;
+    const geometry_t& geometry(element_id_t) const;
+    void              geometry(element_id_t, const geometry_t&);
+
+    // window client area the scene is laid out in
+    void resize(int width, int height);
+
+    // resolves every element if anything changed since the last call
+    void layout();
+    bool dirty() const;
+
+    /* topmost element, i.e. the last one in scene order, containing the point
+     * in window coordinates, npos if there's none; lays the scene out first,
+     * the spatial index behind it is rebuilt on the first query after a
+     * layout
+     */
+    element_id_t hit_test(int x, int y);
+
+    std::span<const element_id_t>   parents() const;
+    std::span<const element_kind_t> kinds() const;
+    std::span<const int>            x() const;
+    std::span<const int>            y() const;
+    std::span<const int>            w() const;
+    std::span<const int>            h() const;
+};
+}
+
+#endif // SK_SCENE_HPP
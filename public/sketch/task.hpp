@@ -0,0 +1,247 @@
+#pragma once
+#ifndef SK_TASK_HPP
+#define SK_TASK_HPP
+
+#include <coroutine>
+#include <cstdint>
+#include <exception>
+#include <utility>
+
+namespace sk {
+
+namespace impl {
+
+/* coroutine frames come from per-thread free lists of a few size classes, so
+ * starting a task does not hit the global allocator once the pool is warm
+ */
+void* allocate_frame(std::size_t size);
+void  deallocate_frame(void* frame, std::size_t size) noexcept;
+
+/* an exception escaping a task can't be thrown out of whoever resumed it
+ * without leaking its frame, so it's kept per thread and rethrown by the
+ * application loop, out of application_t::run; the first one is kept, the
+ * later ones are only counted and the count goes to std::cerr on rethrow
+ *
+ * only the main thread's failure is ever checked: a task that fails after
+ * being resumed on a worker thread is never reported
+ */
+void fail_task(std::exception_ptr) noexcept;
+void rethrow_failed_task();
+
+template <typename NodeType>
+struct wait_node_t {
+    NodeType*               prev = {nullptr};
+    NodeType*               next = {nullptr};
+    std::coroutine_handle<> handle;
+};
+
+/* intrusive list of suspended awaiters, the nodes live inside the awaiting
+ * coroutine frames so waiting never allocates
+ */
+template <typename NodeType>
+class wait_list_t {
+    NodeType* _head = {nullptr};
+    NodeType* _tail = {nullptr};
+
+public:
+    wait_list_t& operator=(const wait_list_t&) = delete;
+    wait_list_t(const wait_list_t&)            = delete;
+
+    wait_list_t() = default;
+    wait_list_t(wait_list_t&& other) noexcept
+        : _head(std::exchange(other._head, nullptr)),
+          _tail(std::exchange(other._tail, nullptr))
+    {
+    }
+
+    wait_list_t&
+    operator=(wait_list_t&& other) noexcept
+    {
+        destroy();
+        _head = std::exchange(other._head, nullptr);
+        _tail = std::exchange(other._tail, nullptr);
+        return *this;
+    }
+
+    ~wait_list_t() { destroy(); }
+
+    bool
+    empty() const
+    {
+        return !_head;
+    }
+
+    void
+    push_back(NodeType& node)
+    {
+        node.prev = _tail;
+        node.next = nullptr;
+        if (_tail) {
+            _tail->next = &node;
+        } else {
+            _head = &node;
+        }
+        _tail = &node;
+    }
+
+    void
+    erase(NodeType& node)
+    {
+        (node.prev ? node.prev->next : _head) = node.next;
+        (node.next ? node.next->prev : _tail) = node.prev;
+        node.prev = node.next = nullptr;
+    }
+
+    /* resumes everybody waiting right now, prepare(node) fills the awaited
+     * value in first; coroutines that wait again are queued for the next
+     * round; if either throws, those not resumed yet are put back in front
+     */
+    template <typename FuncType>
+    void
+    resume_all(FuncType&& prepare)
+    {
+        auto node = std::exchange(_head, nullptr);
+        auto last = std::exchange(_tail, nullptr);
+        while (node) {
+            // the node goes away with its frame once resumed
+            const auto next = node->next;
+            try {
+                prepare(*node);
+            } catch (...) {
+                reattach(node, last);
+                throw;
+            }
+            try {
+                node->handle.resume();
+            } catch (...) {
+                reattach(next, last);
+                throw;
+            }
+            node = next;
+        }
+    }
+
+    template <typename FuncType>
+    void
+    for_each(FuncType&& func)
+    {
+        for (auto node = _head; node; node = node->next) {
+            func(*node);
+        }
+    }
+
+    // puts the nodes from first to last back in front of the list
+    void
+    reattach(NodeType* first, NodeType* last) noexcept
+    {
+        if (!first) {
+            return;
+        }
+
+        first->prev = nullptr;
+        last->next  = _head;
+        (_head ? _head->prev : _tail) = last;
+        _head                         = first;
+    }
+
+    // drops the suspended coroutines along with their frames
+    void
+    destroy()
+    {
+        auto node = std::exchange(_head, nullptr);
+        _tail     = nullptr;
+        while (node) {
+            const auto next = node->next;
+            node->handle.destroy();
+            node = next;
+        }
+    }
+};
+
+// awaits the next value delivered to the list it queues itself on
+template <typename ValueType>
+class value_awaiter_t : public wait_node_t<value_awaiter_t<ValueType>> {
+    wait_list_t<value_awaiter_t>& _list;
+
+public:
+    ValueType value = {};
+
+    explicit value_awaiter_t(wait_list_t<value_awaiter_t>& list) : _list(list)
+    {
+    }
+
+    bool
+    await_ready() const noexcept
+    {
+        return false;
+    }
+
+    void
+    await_suspend(std::coroutine_handle<> awaiting) noexcept
+    {
+        this->handle = awaiting;
+        _list.push_back(*this);
+    }
+
+    ValueType
+    await_resume() noexcept
+    {
+        return std::move(value);
+    }
+};
+}
+
+/* fire-and-forget coroutine driven by the application loop: it runs
+ * synchronously up to its first co_await and frees itself when it finishes
+ * or when the window it waits on is destroyed; its exceptions come out of
+ * application_t::run as long as it fails on the main thread, see fail_task
+ */
+class task_t final {
+public:
+    struct promise_type {
+        task_t
+        get_return_object() noexcept
+        {
+            return {};
+        }
+
+        std::suspend_never
+        initial_suspend() noexcept
+        {
+            return {};
+        }
+
+        std::suspend_never
+        final_suspend() noexcept
+        {
+            return {};
+        }
+
+        void
+        return_void() noexcept
+        {
+        }
+
+        void
+        unhandled_exception() noexcept
+        {
+            // the frame is freed on final suspend, see fail_task
+            impl::fail_task(std::current_exception());
+        }
+
+        static void*
+        operator new(std::size_t size)
+        {
+            return impl::allocate_frame(size);
+        }
+
+        static void
+        operator delete(void* frame, std::size_t size) noexcept
+        {
+            impl::deallocate_frame(frame, size);
+        }
+    };
+};
+}
+
+#endif // SK_TASK_HPP
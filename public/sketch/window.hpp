@@ -2,12 +2,21 @@
 #ifndef SK_WINDOW_HPP
 #define SK_WINDOW_HPP
 
+#include <chrono>
 #include <cstdint>
 #include <functional>
 #include <memory>
+#include <string>
 #include <string_view>
+#include <type_traits>
 
+#include <sketch/canvas.hpp>
+#include <sketch/capture.hpp>
+#include <sketch/geometry.hpp>
+#include <sketch/keyboard.hpp>
 #include <sketch/reactor.hpp>
+#include <sketch/scene.hpp>
+#include <sketch/task.hpp>
 
 struct SDL_Window;
 
@@ -15,20 +24,114 @@ namespace sk {
 
 class application_t;
 
+using timer_id_t = std::uint64_t;
+
+/* generational reference to a window added to an application, it never
+ * dangles: once the window is gone, lookups through it simply fail
+ */
+struct window_handle_t {
+    std::uint32_t index      = {UINT32_MAX};
+    std::uint32_t generation = {0};
+
+    bool operator==(const window_handle_t&) const = default;
+};
+
 class window_t final {
     friend class application_t;
 
+public:
+    using key_awaiter_t = impl::value_awaiter_t<std::size_t>;
+    using mouse_move_awaiter_t =
+        impl::value_awaiter_t<std::tuple<std::size_t, std::size_t>>;
+    using frame_awaiter_t =
+        impl::value_awaiter_t<std::chrono::steady_clock::time_point>;
+
+    class sleep_awaiter_t : public impl::wait_node_t<sleep_awaiter_t> {
+        friend class window_t;
+
+        window_t&                 _window;
+        std::chrono::milliseconds _delay;
+
+    public:
+        sleep_awaiter_t(window_t& window, std::chrono::milliseconds delay)
+            : _window(window), _delay(delay)
+        {
+        }
+
+        bool
+        await_ready() const noexcept
+        {
+            return _delay <= std::chrono::milliseconds::zero();
+        }
+
+        void
+        await_suspend(std::coroutine_handle<> awaiting)
+        {
+            this->handle = awaiting;
+            _window.sleep(*this);
+        }
+
+        void
+        await_resume() const noexcept
+        {
+        }
+    };
+
+private:
     std::unique_ptr<SDL_Window, std::function<void(SDL_Window*)>> _window;
 
-    reactor_t      _reactor;
-    application_t* _app = {nullptr};
+    std::string     _title;
+    geometry_t      _geometry;
+    scene_t         _scene;
+    canvas_t        _canvas;
+    reactor_t       _reactor;
+    keyboard_t      _keyboard;
+    application_t*  _app        = {nullptr};
+    window_handle_t _handle     = {};
+    std::uint32_t   _id         = {0};          // SDL window id
+    std::uint32_t   _timer_list = {UINT32_MAX}; // timers it owns
+    element_id_t    _hovered    = {scene_t::npos};
+
+    // frame pacing, see application_t::service_frames
+    std::chrono::nanoseconds _frame_interval = {
+        std::chrono::nanoseconds(1'000'000'000) / 60};
+    std::uint64_t _frame_epoch = {0};
+    bool          _throttled   = {false};
+
+    // suspended coroutines, resumed from the application loop
+    impl::wait_list_t<key_awaiter_t>        _key_waiters;
+    impl::wait_list_t<mouse_move_awaiter_t> _mouse_move_waiters;
+    impl::wait_list_t<frame_awaiter_t>      _frame_waiters;
+    impl::wait_list_t<sleep_awaiter_t>      _sleepers;
+
+    timer_id_t schedule(
+        std::chrono::milliseconds                       delay,
+        std::chrono::milliseconds                       period,
+        std::function<void(gsl::not_null<window_t*>)>&& func);
+    using continuation_t = std::function<void(gsl::not_null<window_t*>)>;
+
+    void submit(std::function<void()>&& job);
+    bool request_capture(capture_format_t, capture_handler_t&&);
+    void sleep(sleep_awaiter_t&);
+    void place(int x, int y, int w, int h); // resolved geometry
+
+    /* made on the main thread, called from workers: it queues a continuation
+     * that runs only if the window still exists by then
+     */
+    std::function<void(continuation_t&&)> poster();
 
 public:
+    /* moving a window cancels the timers it owns, sleep_for included, as
+     * they call the window they were scheduled on
+     */
     window_t& operator=(const window_t&) = delete;
-    window_t& operator=(window_t&&) = default;
-    window_t(const window_t&)       = delete;
-    window_t(window_t&&)            = default;
+    window_t& operator=(window_t&&) noexcept;
+    window_t(const window_t&) = delete;
+    window_t(window_t&&) noexcept;
+
+    window_t(std::string_view title, const geometry_t& geometry);
 
+    // absolute screen coordinates, kept relative to the first display
     window_t(
         std::string_view title,
         const std::tuple<std::size_t, std::size_t, std::size_t, std::size_t>&
@@ -37,9 +140,141 @@ public:
 
     operator SDL_Window*();
 
-    reactor_t& reactor();
-    void       reactor(reactor_t&&);
-    void       quit();
+    reactor_t&       reactor();
+    void             reactor(reactor_t&&);
+    void             quit();
+    void             close(); // removes the window from its application
+    std::string_view title() const;
+
+    // handle within the application, the default one until the window is
+    // added
+    window_handle_t handle() const;
+
+    /* constraints the window is laid out with, they're re-resolved whenever
+     * the display changes; new ones take effect with the next frame
+     */
+    const geometry_t& geometry() const;
+    void              geometry(const geometry_t&);
+
+    /* elements drawn in the window, laid out against its client area before
+     * it's drawn and whenever it's resized
+     */
+    scene_t&       scene();
+    const scene_t& scene() const;
+
+    // software drawing straight into the window, see canvas_t
+    canvas_t& canvas();
+
+    /* reads the window surface back on the main thread, encodes it on a
+     * worker thread and hands the capture over to the function on the main
+     * thread, unless the window is gone by then; captures that would take
+     * the main thread past its share of the frame budget are refused, this
+     * returns false then, see impl::capture_pool_t
+     */
+    template <typename FuncType>
+    bool
+    capture(capture_format_t format, FuncType&& func)
+    {
+        static_assert(std::is_invocable_v<FuncType,
+                                          gsl::not_null<window_t*>,
+                                          capture_t&&>);
+        return request_capture(
+            format, capture_handler_t(std::forward<FuncType>(func)));
+    }
+
+    // keys held down and shortcuts, see keyboard_t
+    keyboard_t&       keyboard();
+    const keyboard_t& keyboard() const;
+
+    // runs the function once after the delay, the window has to be added to
+    // an application first
+    template <typename FuncType>
+    timer_id_t
+    schedule_after(std::chrono::milliseconds delay, FuncType&& func)
+    {
+        static_assert(std::is_invocable_v<FuncType, gsl::not_null<window_t*>>);
+        return schedule(
+            delay,
+            std::chrono::milliseconds::zero(),
+            std::forward<FuncType>(func));
+    }
+
+    // runs the function periodically until the timer is cancelled
+    template <typename FuncType>
+    timer_id_t
+    schedule_every(std::chrono::milliseconds period, FuncType&& func)
+    {
+        static_assert(std::is_invocable_v<FuncType, gsl::not_null<window_t*>>);
+        return schedule(period, period, std::forward<FuncType>(func));
+    }
+
+    // cancels a timer of this window, false for any other id
+    bool cancel(timer_id_t);
+
+    // runs the job on a worker thread
+    template <typename JobType>
+    void
+    spawn(JobType&& job)
+    {
+        static_assert(std::is_invocable_v<JobType>);
+        submit(std::forward<JobType>(job));
+    }
+
+    /* runs the job on a worker thread, then hands its result over to the
+     * continuation, which runs on the main thread as part of the application
+     * loop
+     */
+    template <typename JobType, typename ThenType>
+    void
+    spawn(JobType&& job, ThenType&& then)
+    {
+        using result_t = std::invoke_result_t<JobType>;
+        if constexpr (std::is_void_v<result_t>) {
+            static_assert(
+                std::is_invocable_v<ThenType, gsl::not_null<window_t*>>);
+            submit([post = poster(),
+                    job  = std::forward<JobType>(job),
+                    then = std::forward<ThenType>(then)]() mutable {
+                job();
+                post([then = std::move(then)](
+                         gsl::not_null<window_t*> window) mutable {
+                    then(window);
+                });
+            });
+        } else {
+            static_assert(
+                std::is_invocable_v<ThenType,
+                                    gsl::not_null<window_t*>,
+                                    result_t&&>);
+            submit([post = poster(),
+                    job  = std::forward<JobType>(job),
+                    then = std::forward<ThenType>(then)]() mutable {
+                post([then = std::move(then), result = job()](
+                         gsl::not_null<window_t*> window) mutable {
+                    then(window, std::move(result));
+                });
+            });
+        }
+    }
+
+    /* target number of on_draw calls per second, from 1 to 1e9, one call
+     * per nanosecond; hidden and minimized windows are throttled regardless
+     * of it
+     */
+    void        frame_rate(std::size_t fps);
+    std::size_t frame_rate() const;
+
+    /* awaitables for sk::task_t coroutines, e.g.
+     *
+     *     sk::task_t blink(sk::window_t& window) {
+     *         co_await window.next_key();
+     *         co_await window.sleep_for(300ms);
+     *     }
+     */
+    key_awaiter_t        next_key();
+    mouse_move_awaiter_t next_mouse_move();
+    frame_awaiter_t      next_frame();
+    sleep_awaiter_t      sleep_for(std::chrono::milliseconds);
 };
 }
 
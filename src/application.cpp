@@ -1,47 +1,529 @@
 #include <sketch/application.hpp>
 
+#include <iostream>
 #include <stdexcept>
+#include <thread>
 
 #include <SDL.h>
 
+#include "capture.hpp"
+#include "event_log.hpp"
 #include "fps_ctl.hpp"
+#include "frame_scheduler.hpp"
+#include "introspection_server.hpp"
+#include "job_system.hpp"
+#include "layout_engine.hpp"
+#include "layout_segment.hpp"
+#include "metrics.hpp"
+#include "sdl2_display.hpp"
+#include "timer_wheel.hpp"
+#include "window_registry.hpp"
+
+using namespace std::chrono_literals;
 
 namespace sk {
 
 namespace {
 
+// hidden and minimized windows are still drawn, but only this often
+constexpr auto throttled_frame_interval = std::chrono::nanoseconds(1s);
+
+/* not every display change comes with an event, e.g. a mode switch doesn't,
+ * so display bounds are also polled this often
+ */
+constexpr auto display_poll_interval = std::chrono::milliseconds(1s);
+
+// how often a followed layout segment is checked for a new generation, a
+// check is a single load
+constexpr auto layout_poll_interval = std::chrono::milliseconds(100ms);
+
+// removed windows destroyed per loop iteration
+constexpr std::size_t releases_per_frame = {1};
+
+std::uint64_t
+frame_key(window_handle_t handle)
+{
+    return (static_cast<std::uint64_t>(handle.generation) << 32u) |
+           handle.index;
+}
+
+window_handle_t
+from_frame_key(std::uint64_t key)
+{
+    return {static_cast<std::uint32_t>(key & UINT32_MAX),
+            static_cast<std::uint32_t>(key >> 32u)};
+}
+
+key_event_t
+to_key_event(const SDL_KeyboardEvent& event)
+{
+    const auto mod       = event.keysym.mod;
+    auto       modifiers = modifiers_t::none;
+    if (mod & KMOD_SHIFT) {
+        modifiers = modifiers | modifiers_t::shift;
+    }
+    if (mod & KMOD_CTRL) {
+        modifiers = modifiers | modifiers_t::ctrl;
+    }
+    if (mod & KMOD_ALT) {
+        modifiers = modifiers | modifiers_t::alt;
+    }
+    if (mod & KMOD_GUI) {
+        modifiers = modifiers | modifiers_t::gui;
+    }
+
+    return {static_cast<scancode_t>(event.keysym.scancode),
+            event.keysym.sym,
+            modifiers,
+            event.state == SDL_PRESSED,
+            event.repeat != 0};
+}
+
+std::uint32_t
+window_id(const SDL_Event& event)
+{
+    switch (event.type) {
+    case SDL_WINDOWEVENT: return event.window.windowID;
+    case SDL_KEYDOWN:
+    case SDL_KEYUP: return event.key.windowID;
+    case SDL_TEXTINPUT: return event.text.windowID;
+    case SDL_MOUSEMOTION: return event.motion.windowID;
+    default: return 0;
+    }
+}
+}
+
+application_t::application_t()
+    : _timers(std::make_unique<impl::timer_wheel_t>()),
+      _frames(std::make_unique<impl::frame_scheduler_t>()),
+      _layout(std::make_unique<impl::layout_engine_t>()),
+      _windows(std::make_unique<impl::window_registry_t>())
+{
+    if (SDL_Init(SDL_INIT_VIDEO) < 0) {
+        throw std::runtime_error(SDL_GetError());
+    }
+
+    refresh_displays();
+    _timers->schedule(
+        display_poll_interval,
+        display_poll_interval,
+        [this] { refresh_displays(); });
+}
+
+application_t::~application_t()
+{
+    // workers may still refer to windows
+    _jobs.reset();
+    _removed.clear();
+    _windows.reset();
+    SDL_Quit();
+}
+
+window_handle_t
+application_t::add(window_t&& window)
+{
+    auto       owned = std::make_unique<window_t>(std::move(window));
+    auto&      added = *owned;
+    const auto id    = added._id;
+    auto       title = added._title;
+
+    added._app    = this;
+    added._handle = _windows->insert(std::move(owned), id, std::move(title));
+    if (static_cast<std::size_t>(added._geometry.display) >=
+        _layout->parents()) {
+        refresh_displays();
+    }
+    _layout->attach(added._handle.index, added._geometry);
+    if (_metrics) {
+        _metrics->attach(
+            added._handle.index, added._handle.generation, added._title);
+        measure(added);
+    }
+    schedule_frame(added, 0ns);
+    return added._handle;
+}
+
 void
-handle_events(reactor_t& reactor)
+application_t::remove(window_handle_t handle)
 {
+    auto window = _windows->erase(handle);
+    if (!window) {
+        return;
+    }
+
+    SDL_HideWindow(*window);
+    _timers->cancel_all(window->_timer_list);
+    _layout->detach(handle.index);
+    if (_metrics) {
+        _metrics->detach(handle.index);
+    }
+    _removed.push_back(std::move(window));
+
+    if (!_windows->size()) {
+        quit();
+    }
+}
+
+window_t*
+application_t::get(window_handle_t handle) const
+{
+    return _windows->get(handle);
+}
+
+window_t*
+application_t::find(std::uint32_t sdl_window_id) const
+{
+    return _windows->find(sdl_window_id);
+}
+
+window_t*
+application_t::find(std::string_view title) const
+{
+    return _windows->find(title);
+}
+
+std::size_t
+application_t::size() const
+{
+    return _windows->size();
+}
+
+impl::job_system_t&
+application_t::jobs()
+{
+    if (!_jobs) {
+        _jobs = std::make_unique<impl::job_system_t>();
+    }
+
+    return *_jobs;
+}
+
+void
+application_t::schedule_frame(window_t& window, std::chrono::nanoseconds delay)
+{
+    _frames->schedule(
+        frame_key(window._handle),
+        ++window._frame_epoch,
+        impl::frame_scheduler_t::clock_t::now() + delay);
+}
+
+void
+application_t::handle_events()
+{
+    if (_player) {
+        _player->inject(
+            impl::event_player_t::clock_t::now(),
+            [this](std::size_t index) -> std::uint32_t {
+                const auto window =
+                    _windows->at_slot(static_cast<std::uint32_t>(index));
+                return window ? window->_id : 0;
+            });
+    }
+
     SDL_Event event;
     while (SDL_PollEvent(&event)) {
+        const auto started = std::chrono::steady_clock::now();
+        const auto window  = find(window_id(event));
+        if (_metrics) {
+            _metrics->event(
+                window ? std::optional(window->_handle.index) : std::nullopt);
+        }
+        if (_recorder && (window || event.type == SDL_QUIT)) {
+            _recorder->record(event, window ? window->_handle.index : 0);
+        }
+
         switch (event.type) {
-        case SDL_QUIT: reactor.on_quit(); break;
-        case SDL_KEYDOWN: reactor.on_keydown(event.key.keysym.sym); break;
+        case SDL_QUIT: {
+            /* callbacks may add or remove windows, and removing one moves
+             * another into its place, so the windows are taken beforehand
+             * and those removed in the meantime skipped
+             */
+            std::vector<window_handle_t> handles;
+            handles.reserve(_windows->size());
+            for (const auto* quitting : *_windows) {
+                handles.push_back(quitting->_handle);
+            }
+            for (const auto handle : handles) {
+                if (auto* quitting = _windows->get(handle)) {
+                    quitting->reactor().on_quit();
+                }
+            }
+        } break;
+#if SDL_VERSION_ATLEAST(2, 0, 9)
+        case SDL_DISPLAYEVENT: refresh_displays(); break;
+#endif
+        case SDL_WINDOWEVENT:
+            if (window) {
+                handle_window_event(*window, event.window);
+            }
+            break;
+        case SDL_KEYDOWN:
+        case SDL_KEYUP:
+            if (window) {
+                // the key state is up to date before anything is called
+                const auto key_event = to_key_event(event.key);
+                window->_keyboard.update(key_event);
+                if (key_event.pressed) {
+                    const auto key =
+                        static_cast<std::size_t>(event.key.keysym.sym);
+                    window->reactor().on_keydown(key);
+                    window->_key_waiters.resume_all(
+                        [key](auto& awaiter) { awaiter.value = key; });
+                }
+                window->reactor().on_key(key_event);
+                window->_keyboard.dispatch(key_event);
+            }
+            break;
+        case SDL_TEXTINPUT:
+            if (window) {
+                window->reactor().on_text(event.text.text);
+            }
+            break;
         case SDL_MOUSEMOTION:
-            reactor.on_mouse_move(
-                std::tuple{static_cast<std::size_t>(event.motion.x),
-                           static_cast<std::size_t>(event.motion.y)});
+            if (window) {
+                const auto point =
+                    std::tuple{static_cast<std::size_t>(event.motion.x),
+                               static_cast<std::size_t>(event.motion.y)};
+                window->reactor().on_mouse_move(point);
+                window->_mouse_move_waiters.resume_all(
+                    [&point](auto& awaiter) { awaiter.value = point; });
+                hover(*window, event.motion.x, event.motion.y);
+            }
             break;
         default: break;
         }
+
+        if (_player) {
+            _player->measure_event(std::chrono::steady_clock::now() - started);
+        }
     }
 }
+
+void
+application_t::handle_window_event(
+    window_t& window, const SDL_WindowEvent& event)
+{
+    auto& reactor = window.reactor();
+    switch (event.event) {
+    case SDL_WINDOWEVENT_CLOSE: reactor.on_close(); break;
+    case SDL_WINDOWEVENT_HIDDEN:
+        window._throttled = true;
+        reactor.on_hide();
+        break;
+    case SDL_WINDOWEVENT_MINIMIZED:
+        window._throttled = true;
+        reactor.on_minimize();
+        break;
+    case SDL_WINDOWEVENT_SHOWN:
+        unthrottle(window);
+        reactor.on_show();
+        break;
+    case SDL_WINDOWEVENT_RESTORED:
+        unthrottle(window);
+        reactor.on_restore();
+        break;
+    case SDL_WINDOWEVENT_MAXIMIZED: unthrottle(window); break;
+    case SDL_WINDOWEVENT_EXPOSED:
+        unthrottle(window);
+        reactor.on_expose();
+        break;
+    case SDL_WINDOWEVENT_LEAVE: hover(window, -1, -1); break;
+    case SDL_WINDOWEVENT_FOCUS_GAINED: reactor.on_focus(true); break;
+    case SDL_WINDOWEVENT_FOCUS_LOST:
+        window._keyboard.release_all();
+        reactor.on_focus(false);
+        break;
+    case SDL_WINDOWEVENT_MOVED: measure(window); break;
+    case SDL_WINDOWEVENT_SIZE_CHANGED:
+        window._scene.resize(event.data1, event.data2);
+        window._scene.layout();
+        measure(window);
+        reactor.on_resize(std::tuple{static_cast<std::size_t>(event.data1),
+                                     static_cast<std::size_t>(event.data2)});
+        break;
+    default: break;
+    }
 }
 
-application_t::application_t()
+void
+application_t::unthrottle(window_t& window)
 {
-    if (SDL_Init(SDL_INIT_VIDEO) < 0) {
-        throw std::runtime_error(SDL_GetError());
+    // redraw right away instead of waiting for a throttled frame
+    window._throttled = false;
+    schedule_frame(window, 0ns);
+}
+
+void
+application_t::refresh_displays()
+{
+    // windows of displays whose bounds didn't change aren't touched
+    const auto displays = impl::sdl2::display::count();
+    for (std::size_t i = 0; i < displays; ++i) {
+        _layout->parent_bounds(
+            i, impl::sdl2::display::get_rect(static_cast<int>(i)));
     }
 }
 
-application_t::~application_t() { SDL_Quit(); }
 void
-application_t::add(window_t&& window)
+application_t::constrain(window_t& window)
+{
+    if (static_cast<std::size_t>(window._geometry.display) >=
+        _layout->parents()) {
+        refresh_displays();
+    }
+
+    _layout->constrain(window._handle.index, window._geometry);
+}
+
+void
+application_t::relayout()
+{
+    _layout->update([this](std::uint32_t slot, const auto& rect) {
+        if (auto window = _windows->at_slot(slot)) {
+            window->place(rect.x, rect.y, rect.w, rect.h);
+            measure(*window);
+        }
+    });
+}
+
+void
+application_t::follow(std::string_view segment)
+{
+    // windows of a segment followed before are matched against the new one
+    auto follower = std::make_unique<impl::layout_follower_t>(segment);
+    const auto following = static_cast<bool>(_follower);
+    if (following) {
+        follower->windows = std::move(_follower->windows);
+    }
+
+    _follower = std::move(follower);
+    follow_layout();
+    if (!following) {
+        _timers->schedule(
+            layout_poll_interval,
+            layout_poll_interval,
+            [this] { follow_layout(); });
+    }
+}
+
+void
+application_t::follow_layout()
+{
+    auto& follower = *_follower;
+    if (follower.segment.generation() == follower.generation) {
+        return;
+    }
+
+    // a publish under way is picked up by the next poll
+    auto published = follower.segment.read();
+    if (!published) {
+        return;
+    }
+
+    auto& [specs, generation] = *published;
+    follower.generation       = generation;
+
+    // replaced windows go last, so that the application doesn't quit midway
+    std::vector<window_handle_t> windows;
+    std::vector<window_handle_t> replaced;
+    for (std::size_t i = 0; i < specs.size(); ++i) {
+        const auto handle = (i < follower.windows.size()) ? follower.windows[i]
+                                                          : window_handle_t{};
+        auto* window = get(handle);
+        if (window && window->_title == specs[i].title) {
+            window->geometry(specs[i].geometry);
+            impl::fill_scene(window->_scene, specs[i]);
+            window->_hovered = scene_t::npos;
+            windows.push_back(handle);
+            continue;
+        }
+
+        if (window) {
+            replaced.push_back(handle);
+        }
+        windows.push_back(add(impl::make_window(specs[i])));
+    }
+    for (auto i = specs.size(); i < follower.windows.size(); ++i) {
+        replaced.push_back(follower.windows[i]);
+    }
+
+    follower.windows = std::move(windows);
+    for (const auto handle : replaced) {
+        remove(handle);
+    }
+}
+
+void
+application_t::measure(window_t& window)
+{
+    if (!_metrics) {
+        return;
+    }
+
+    int x, y, width, height;
+    SDL_GetWindowPosition(window, &x, &y);
+    SDL_GetWindowSize(window, &width, &height);
+    _metrics->place(window._handle.index, x, y, width, height);
+}
+
+void
+application_t::hover(window_t& window, int x, int y)
+{
+    auto&      reactor = window.reactor();
+    const auto hit     = window._scene.hit_test(x, y);
+    if (hit != window._hovered) {
+        // the element may be gone if the scene was rebuilt in the meantime
+        if (window._hovered < window._scene.size()) {
+            reactor.on_leave(window._hovered);
+        }
+        window._hovered = hit;
+        if (hit != scene_t::npos) {
+            reactor.on_enter(hit);
+        }
+    }
+
+    if (hit != scene_t::npos) {
+        reactor.on_hover(
+            hit,
+            std::tuple{static_cast<std::size_t>(x),
+                       static_cast<std::size_t>(y)});
+    }
+}
+
+std::size_t
+application_t::service_frames()
 {
-    window._app = this;
-    _windows.emplace_back(std::move(window));
+    std::size_t drawn = 0;
+    const auto  now   = impl::frame_scheduler_t::clock_t::now();
+    _frames->run_due(
+        now,
+        [this, now, &drawn](
+            std::uint64_t key, std::uint64_t epoch, auto deadline)
+            -> std::optional<impl::frame_scheduler_t::clock_t::time_point> {
+            const auto found = _windows->get(from_frame_key(key));
+            if (!found || epoch != found->_frame_epoch) {
+                return std::nullopt;
+            }
+
+            auto& window = *found;
+            ++drawn;
+            if (_metrics) {
+                _metrics->drawn(window._handle.index);
+            }
+            window._scene.layout();
+            window.reactor().on_draw();
+            window._frame_waiters.resume_all(
+                [deadline](auto& awaiter) { awaiter.value = deadline; });
+
+            // frames that were missed are skipped rather than drawn in a
+            // burst
+            const auto interval = window._throttled ? throttled_frame_interval
+                                                    : window._frame_interval;
+            const auto next = deadline + interval;
+            return (next > now) ? next : now + interval;
+        });
+
+    return drawn;
 }
 
 int
@@ -52,16 +534,161 @@ application_t::run()
 
     // application loop
     while (is_running()) {
-        for (auto& window : _windows) {
-            handle_events(window.reactor());
+        const auto started = std::chrono::steady_clock::now();
+        if (_metrics) {
+            _metrics->begin_frame();
+        }
+        handle_events();
+        if (_jobs) {
+            _jobs->drain();
+        }
+        _timers->advance();
+        relayout();
+        const auto drawn = service_frames();
+        impl::rethrow_failed_task();
+
+        if (_player) {
+            _player->measure_frame(std::chrono::steady_clock::now() - started);
+            if (_player->finished()) {
+                _player->report(std::cout);
+                _player.reset();
+                quit();
+            }
+        }
+
+        for (std::size_t i = 0; i < releases_per_frame && !_removed.empty();
+             ++i) {
+            _removed.pop_back();
         }
 
-        fps_ctl.update();
+        if (_metrics) {
+            impl::metrics_t::totals_t depths;
+            depths.fps     = fps_ctl.get_fps();
+            depths.timers  = _timers->size();
+            depths.queued  = _frames->size();
+            depths.jobs    = _jobs ? _jobs->pending() : 0;
+            depths.removed = _removed.size();
+            _metrics->end_frame(depths);
+        }
+
+        const auto wake_up = fps_ctl.update(
+            drawn > 0,
+            std::min(
+                {_timers->next_deadline(),
+                 _frames->next_deadline(),
+                 _player ? _player->next_deadline()
+                         : std::chrono::steady_clock::time_point::max()}));
+        if (_jobs) {
+            // finished jobs wake the loop up early
+            _jobs->wait_until(wake_up);
+        } else {
+            std::this_thread::sleep_until(wake_up);
+        }
     }
 
     return EXIT_SUCCESS;
 }
 
+bool
+application_t::capture(
+    window_t& window, capture_format_t format, capture_handler_t&& handler)
+{
+    if (!_captures) {
+        _captures = std::make_unique<impl::capture_pool_t>();
+    }
+
+    auto* surface = SDL_GetWindowSurface(window);
+    if (!surface) {
+        throw std::runtime_error(SDL_GetError());
+    }
+
+    const auto started = impl::capture_pool_t::clock_t::now();
+    const auto bytes   = static_cast<std::size_t>(std::max(surface->w, 0)) *
+                       static_cast<std::size_t>(std::max(surface->h, 0)) * 4;
+    auto pixels = _captures->acquire(started, bytes, window._frame_interval);
+    if (!pixels) {
+        return false;
+    }
+
+    impl::pixel_layout_t layout;
+    try {
+        layout = impl::read_surface(surface, *pixels);
+    } catch (...) {
+        _captures->release({});
+        throw;
+    }
+    _captures->spent(impl::capture_pool_t::clock_t::now() - started, bytes);
+
+    // png encoding gives the pixels back to the pool, raw captures keep them
+    auto& workers = jobs();
+    auto  capture = capture_t{format, surface->w, surface->h, started, {}};
+    workers.submit([pool    = _captures.get(),
+                    workers = &workers,
+                    post    = window.poster(),
+                    handler = std::move(handler),
+                    pixels  = std::move(*pixels),
+                    layout,
+                    capture = std::move(capture)]() mutable {
+        const auto release = [pool, workers](std::vector<std::uint8_t>&& kept) {
+            workers->post([pool, kept = std::move(kept)]() mutable {
+                pool->release(std::move(kept));
+            });
+        };
+
+        try {
+            impl::to_rgba(pixels, layout);
+            if (capture.format == capture_format_t::png) {
+                capture.data =
+                    impl::encode_png(pixels, capture.width, capture.height);
+                release(std::move(pixels));
+            } else {
+                capture.data = std::move(pixels);
+                release({});
+            }
+        } catch (...) {
+            release({});
+            throw;
+        }
+
+        post([handler = std::move(handler), capture = std::move(capture)](
+                 gsl::not_null<window_t*> captured) mutable {
+            handler(captured, std::move(capture));
+        });
+    });
+    return true;
+}
+
+void
+application_t::introspect(std::string_view path)
+{
+    // the server is replaced first, the old one may still read the metrics
+    _introspection.reset();
+    if (!_metrics) {
+        _metrics = std::make_unique<impl::metrics_t>();
+        for (std::size_t i = 0; i < _windows->size(); ++i) {
+            auto& window = *(*_windows)[i];
+            _metrics->attach(
+                window._handle.index, window._handle.generation, window._title);
+            measure(window);
+        }
+    }
+
+    _introspection =
+        std::make_unique<impl::introspection_server_t>(path, *_metrics);
+}
+
+void
+application_t::record(std::string_view filename)
+{
+    _recorder = std::make_unique<impl::event_recorder_t>(filename);
+}
+
+void
+application_t::replay(std::string_view filename, double speed)
+{
+    _player = std::make_unique<impl::event_player_t>(filename, speed);
+}
+
 void
 application_t::quit()
 {
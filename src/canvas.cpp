@@ -0,0 +1,221 @@
+#include <sketch/canvas.hpp>
+
+#include <algorithm>
+#include <climits>
+#include <stdexcept>
+
+#include <SDL.h>
+
+#include "raster.hpp"
+
+namespace sk {
+
+namespace {
+
+// beyond this many touched rectangles a single bounding one is cheaper
+constexpr std::size_t max_update_rects = {64};
+
+class lock_t final {
+    SDL_Surface* _surface;
+
+public:
+    lock_t& operator=(const lock_t&) = delete;
+    lock_t(const lock_t&)            = delete;
+
+    explicit lock_t(SDL_Surface* surface)
+        : _surface(SDL_MUSTLOCK(surface) ? surface : nullptr)
+    {
+        if (_surface && SDL_LockSurface(_surface)) {
+            throw std::runtime_error(SDL_GetError());
+        }
+    }
+
+    ~lock_t()
+    {
+        if (_surface) {
+            SDL_UnlockSurface(_surface);
+        }
+    }
+};
+
+rect_t
+clip(const rect_t& rect, int width, int height)
+{
+    const auto left   = std::max(rect.x, 0);
+    const auto top    = std::max(rect.y, 0);
+    const auto right  = std::min(rect.x + std::max(rect.w, 0), width);
+    const auto bottom = std::min(rect.y + std::max(rect.h, 0), height);
+    return {left, top, std::max(right - left, 0), std::max(bottom - top, 0)};
+}
+}
+
+canvas_t::canvas_t(SDL_Window* window) : _window(window) {}
+
+SDL_Surface*
+canvas_t::surface()
+{
+    // cached by SDL, fetched every time since it's replaced on resize
+    auto* result = SDL_GetWindowSurface(_window);
+    if (!result) {
+        throw std::runtime_error(SDL_GetError());
+    }
+
+    if (result->format->BytesPerPixel != sizeof(std::uint32_t)) {
+        throw std::runtime_error("window surface is not 32 bits per pixel");
+    }
+
+    return result;
+}
+
+/* calls row(dst, count, x, y) for every row of the rectangle within the
+ * window, x and y being where the row starts relative to the rectangle
+ */
+template <typename FuncType>
+void
+canvas_t::draw(const rect_t& rect, FuncType&& row)
+{
+    auto*      target  = surface();
+    const auto clipped = clip(rect, target->w, target->h);
+    if (!clipped.w || !clipped.h) {
+        return;
+    }
+
+    const lock_t lock(target);
+    auto*        pixels = static_cast<std::uint8_t*>(target->pixels);
+    for (auto y = clipped.y; y < clipped.y + clipped.h; ++y) {
+        auto* line = reinterpret_cast<std::uint32_t*>(
+            pixels + static_cast<std::ptrdiff_t>(y) * target->pitch);
+        row(line + clipped.x,
+            static_cast<std::size_t>(clipped.w),
+            clipped.x - rect.x,
+            y - rect.y);
+    }
+
+    _touched.push_back(clipped);
+}
+
+int
+canvas_t::width()
+{
+    return surface()->w;
+}
+
+int
+canvas_t::height()
+{
+    return surface()->h;
+}
+
+std::uint32_t
+canvas_t::map(color_t color)
+{
+    return SDL_MapRGBA(surface()->format, color.r, color.g, color.b, color.a);
+}
+
+void
+canvas_t::fill(const rect_t& rect, color_t color)
+{
+    const auto  pixel   = map(color);
+    const auto& kernels = impl::raster_kernels();
+    draw(rect, [&](std::uint32_t* dst, std::size_t count, int, int) {
+        kernels.fill(dst, count, pixel);
+    });
+}
+
+void
+canvas_t::blend(const rect_t& rect, color_t color)
+{
+    if (!color.a) {
+        return;
+    }
+
+    if (color.a == 255) {
+        fill(rect, color);
+        return;
+    }
+
+    const auto  pixel   = map(color);
+    const auto& kernels = impl::raster_kernels();
+    draw(rect, [&](std::uint32_t* dst, std::size_t count, int, int) {
+        kernels.blend(dst, count, pixel, color.a);
+    });
+}
+
+void
+canvas_t::outline(const rect_t& rect, color_t color, int thickness)
+{
+    // the edges don't overlap, so translucent outlines blend evenly
+    const auto vertical   = std::clamp(thickness, 0, (rect.h + 1) / 2);
+    const auto horizontal = std::clamp(thickness, 0, (rect.w + 1) / 2);
+    const auto inner      = rect.h - 2 * vertical;
+    const auto right      = rect.x + rect.w - horizontal;
+    if (!vertical || !horizontal) {
+        return;
+    }
+
+    blend({rect.x, rect.y, rect.w, vertical}, color);
+    blend({rect.x, rect.y + rect.h - vertical, rect.w, vertical}, color);
+    if (inner > 0) {
+        blend({rect.x, rect.y + vertical, horizontal, inner}, color);
+        blend({right, rect.y + vertical, horizontal, inner}, color);
+    }
+}
+
+void
+canvas_t::blit(
+    const rect_t&                   to,
+    std::span<const std::uint32_t> pixels,
+    int                             pitch)
+{
+    if (to.w <= 0 || to.h <= 0) {
+        return;
+    }
+
+    pitch = pitch ? pitch : to.w;
+    if (pitch < to.w ||
+        pixels.size() < static_cast<std::size_t>(pitch) *
+                                static_cast<std::size_t>(to.h - 1) +
+                            static_cast<std::size_t>(to.w)) {
+        throw std::invalid_argument("blit source is smaller than its target");
+    }
+
+    const auto& kernels = impl::raster_kernels();
+    draw(to, [&](std::uint32_t* dst, std::size_t count, int x, int y) {
+        kernels.copy(
+            dst,
+            pixels.data() + static_cast<std::ptrdiff_t>(y) * pitch + x,
+            count);
+    });
+}
+
+void
+canvas_t::present()
+{
+    if (_touched.empty()) {
+        return;
+    }
+
+    std::vector<SDL_Rect> rects;
+    if (_touched.size() > max_update_rects) {
+        auto left = INT_MAX, top = INT_MAX, right = INT_MIN, bottom = INT_MIN;
+        for (const auto& rect : _touched) {
+            left   = std::min(left, rect.x);
+            top    = std::min(top, rect.y);
+            right  = std::max(right, rect.x + rect.w);
+            bottom = std::max(bottom, rect.y + rect.h);
+        }
+        rects.push_back({left, top, right - left, bottom - top});
+    } else {
+        rects.reserve(_touched.size());
+        for (const auto& rect : _touched) {
+            rects.push_back({rect.x, rect.y, rect.w, rect.h});
+        }
+    }
+    _touched.clear();
+
+    if (SDL_UpdateWindowSurfaceRects(
+            _window, rects.data(), static_cast<int>(rects.size()))) {
+        throw std::runtime_error(SDL_GetError());
+    }
+}
+}
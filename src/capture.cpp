@@ -0,0 +1,378 @@
+#include "capture.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <stdexcept>
+
+#include <SDL.h>
+
+#include "raster.hpp"
+
+namespace sk::impl {
+
+namespace {
+
+constexpr std::uint8_t png_signature[8] = {
+    0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+
+// bytes a stored deflate block holds at most
+constexpr std::size_t stored_block = {65535};
+
+// largest n such that 255 * n * (n + 1) / 2 + (n + 1) * 65520 < 2^32
+constexpr std::size_t adler_run = {5552};
+
+using crc_table_t = std::array<std::array<std::uint32_t, 256>, 8>;
+
+/* slicing by eight: table[k][byte] is the crc of the byte followed by k zero
+ * bytes, so eight bytes take eight independent lookups instead of a chain
+ */
+constexpr crc_table_t
+make_crc_table()
+{
+    crc_table_t table = {};
+    for (std::uint32_t i = 0; i < 256; ++i) {
+        auto crc = i;
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc & 1u) ? (0xedb88320u ^ (crc >> 1u)) : (crc >> 1u);
+        }
+        table[0][i] = crc;
+    }
+    for (std::size_t k = 1; k < 8; ++k) {
+        for (std::size_t i = 0; i < 256; ++i) {
+            const auto previous = table[k - 1][i];
+            table[k][i] = (previous >> 8u) ^ table[0][previous & 0xffu];
+        }
+    }
+    return table;
+}
+
+constexpr auto crc_table = make_crc_table();
+
+void
+put_u32(std::uint8_t* at, std::uint32_t value)
+{
+    at[0] = static_cast<std::uint8_t>(value >> 24u);
+    at[1] = static_cast<std::uint8_t>(value >> 16u);
+    at[2] = static_cast<std::uint8_t>(value >> 8u);
+    at[3] = static_cast<std::uint8_t>(value);
+}
+
+std::uint8_t
+shift_of(std::uint32_t mask)
+{
+    std::uint8_t shift = 0;
+    while (mask && !(mask & 1u)) {
+        mask >>= 1u;
+        ++shift;
+    }
+    return shift;
+}
+
+constexpr unsigned any_shift = {32}; // taken from the layout at run time
+
+/* channels of every pixel moved to rgba byte order in the host's word order;
+ * shifts are of the layout unless they're given, as is the alpha channel
+ */
+template <unsigned RShift, unsigned GShift, unsigned BShift, bool Alpha>
+void
+convert(std::span<std::uint8_t> pixels, const pixel_layout_t& layout)
+{
+    constexpr auto little = (std::endian::native == std::endian::little);
+    constexpr auto r_to   = little ? 0u : 24u;
+    constexpr auto g_to   = little ? 8u : 16u;
+    constexpr auto b_to   = little ? 16u : 8u;
+    constexpr auto a_to   = little ? 24u : 0u;
+
+    const auto shift = [](unsigned given, std::uint8_t of_layout) {
+        return (given == any_shift) ? unsigned{of_layout} : given;
+    };
+    const auto r_shift = shift(RShift, layout.r_shift);
+    const auto g_shift = shift(GShift, layout.g_shift);
+    const auto b_shift = shift(BShift, layout.b_shift);
+    const auto a_shift = (RShift == any_shift) ? unsigned{layout.a_shift} : 24u;
+
+    const auto alpha  = Alpha && layout.alpha;
+    const auto opaque = alpha ? 0u : 0xffu << a_to;
+    const auto a_mask = alpha ? 0xffu : 0u;
+    for (std::size_t i = 0; i + 4 <= pixels.size(); i += 4) {
+        std::uint32_t pixel;
+        std::memcpy(&pixel, pixels.data() + i, sizeof(pixel));
+        pixel = ((pixel >> r_shift) & 0xffu) << r_to |
+                ((pixel >> g_shift) & 0xffu) << g_to |
+                ((pixel >> b_shift) & 0xffu) << b_to |
+                ((pixel >> a_shift) & a_mask) << a_to | opaque;
+        std::memcpy(pixels.data() + i, &pixel, sizeof(pixel));
+    }
+}
+
+/* writes the filtered image as stored deflate blocks, a block header before
+ * every 65535 bytes wherever they fall
+ */
+class stored_writer_t final {
+    std::uint8_t* _at;
+    std::size_t   _left;       // of the whole stream
+    std::size_t   _block_left = {0};
+    std::uint32_t _adler      = {1};
+
+public:
+    stored_writer_t(std::uint8_t* at, std::size_t size) : _at(at), _left(size)
+    {
+    }
+
+    void
+    write(const std::uint8_t* data, std::size_t size)
+    {
+        _adler = adler32({data, size}, _adler);
+        while (size) {
+            if (!_block_left) {
+                _block_left = std::min(_left, stored_block);
+                const auto length = static_cast<std::uint16_t>(_block_left);
+                _at[0] = (_left == _block_left) ? 1 : 0; // last block?
+                _at[1] = static_cast<std::uint8_t>(length);
+                _at[2] = static_cast<std::uint8_t>(length >> 8u);
+                _at[3] = static_cast<std::uint8_t>(~length);
+                _at[4] = static_cast<std::uint8_t>(~length >> 8u);
+                _at += 5;
+            }
+
+            const auto count = std::min(size, _block_left);
+            std::memcpy(_at, data, count);
+            _at += count;
+            data += count;
+            size -= count;
+            _left -= count;
+            _block_left -= count;
+        }
+    }
+
+    std::uint32_t
+    adler() const
+    {
+        return _adler;
+    }
+};
+}
+
+pixel_layout_t
+read_surface(SDL_Surface* surface, std::vector<std::uint8_t>& pixels)
+{
+    const auto* format = surface->format;
+    if (format->BytesPerPixel != sizeof(std::uint32_t)) {
+        throw std::runtime_error("window surface is not 32 bits per pixel");
+    }
+
+    const auto width  = static_cast<std::size_t>(std::max(surface->w, 0));
+    const auto height = static_cast<std::size_t>(std::max(surface->h, 0));
+    pixels.resize(width * height * sizeof(std::uint32_t));
+
+    if (SDL_MUSTLOCK(surface) && SDL_LockSurface(surface)) {
+        throw std::runtime_error(SDL_GetError());
+    }
+
+    // rows are copied as they are, converting them is left to a worker
+    const auto& kernels = raster_kernels();
+    const auto* source  = static_cast<const std::uint8_t*>(surface->pixels);
+    auto*       target  = reinterpret_cast<std::uint32_t*>(pixels.data());
+    for (std::size_t y = 0; y < height; ++y) {
+        kernels.copy(
+            target + y * width,
+            reinterpret_cast<const std::uint32_t*>(
+                source + y * static_cast<std::size_t>(surface->pitch)),
+            width);
+    }
+
+    if (SDL_MUSTLOCK(surface)) {
+        SDL_UnlockSurface(surface);
+    }
+
+    return {shift_of(format->Rmask),
+            shift_of(format->Gmask),
+            shift_of(format->Bmask),
+            shift_of(format->Amask),
+            format->Amask != 0};
+}
+
+void
+to_rgba(std::span<std::uint8_t> pixels, const pixel_layout_t& layout)
+{
+    // the usual layouts get loops of their own, which vectorize
+    const auto is = [&layout](unsigned r, unsigned g, unsigned b) {
+        return layout.r_shift == r && layout.g_shift == g &&
+               layout.b_shift == b && (!layout.alpha || layout.a_shift == 24);
+    };
+
+    if (is(16, 8, 0)) {
+        layout.alpha ? convert<16, 8, 0, true>(pixels, layout)
+                     : convert<16, 8, 0, false>(pixels, layout);
+    } else if (is(0, 8, 16)) {
+        layout.alpha ? convert<0, 8, 16, true>(pixels, layout)
+                     : convert<0, 8, 16, false>(pixels, layout);
+    } else {
+        convert<any_shift, any_shift, any_shift, true>(pixels, layout);
+    }
+}
+
+std::uint32_t
+crc32(std::span<const std::uint8_t> data, std::uint32_t crc)
+{
+    crc              = ~crc;
+    const auto* at   = data.data();
+    auto        left = data.size();
+    for (; left >= 8; at += 8, left -= 8) {
+        const auto low = crc ^ (std::uint32_t{at[0]} |
+                                std::uint32_t{at[1]} << 8u |
+                                std::uint32_t{at[2]} << 16u |
+                                std::uint32_t{at[3]} << 24u);
+        crc = crc_table[7][low & 0xffu] ^ crc_table[6][(low >> 8u) & 0xffu] ^
+              crc_table[5][(low >> 16u) & 0xffu] ^ crc_table[4][low >> 24u] ^
+              crc_table[3][at[4]] ^ crc_table[2][at[5]] ^
+              crc_table[1][at[6]] ^ crc_table[0][at[7]];
+    }
+    for (; left; ++at, --left) {
+        crc = crc_table[0][(crc ^ *at) & 0xffu] ^ (crc >> 8u);
+    }
+    return ~crc;
+}
+
+std::uint32_t
+adler32(std::span<const std::uint8_t> data, std::uint32_t adler)
+{
+    // the modulo is taken once per run rather than once per byte
+    std::uint32_t a = adler & 0xffffu;
+    std::uint32_t b = adler >> 16u;
+    while (!data.empty()) {
+        const auto run = std::min(data.size(), adler_run);
+        for (const auto byte : data.first(run)) {
+            a += byte;
+            b += a;
+        }
+        a %= 65521u;
+        b %= 65521u;
+        data = data.subspan(run);
+    }
+    return (b << 16u) | a;
+}
+
+std::vector<std::uint8_t>
+encode_png(std::span<const std::uint8_t> rgba, int width, int height)
+{
+    const auto columns = static_cast<std::size_t>(std::max(width, 0));
+    const auto rows    = static_cast<std::size_t>(std::max(height, 0));
+    const auto stride  = columns * 4;
+    if (rgba.size() < stride * rows) {
+        throw std::invalid_argument("fewer pixels than the image has");
+    }
+
+    // a filter type byte before every row, then zlib's header and checksum
+    const auto filtered = rows * (1 + stride);
+    const auto blocks   = std::max<std::size_t>(
+        (filtered + stored_block - 1) / stored_block, 1);
+    const auto zlib = 2 + blocks * 5 + filtered + 4;
+    if (zlib > UINT32_MAX - 4) {
+        throw std::length_error("image too large for a png chunk");
+    }
+
+    std::vector<std::uint8_t> result(8 + 25 + 12 + zlib + 12);
+    auto*                     at = result.data();
+    std::memcpy(at, png_signature, 8);
+    at += 8;
+
+    // length, type, data, then the crc of type and data
+    const auto chunk = [&at](const char* type, std::size_t size, auto&& fill) {
+        put_u32(at, static_cast<std::uint32_t>(size));
+        std::memcpy(at + 4, type, 4);
+        fill(at + 8);
+        put_u32(at + 8 + size, crc32({at + 4, size + 4}));
+        at += 12 + size;
+    };
+
+    chunk("IHDR", 13, [&](std::uint8_t* data) {
+        put_u32(data, static_cast<std::uint32_t>(columns));
+        put_u32(data + 4, static_cast<std::uint32_t>(rows));
+        data[8]  = 8; // bits per channel
+        data[9]  = 6; // rgba
+        data[10] = 0; // deflate
+        data[11] = 0; // adaptive filtering
+        data[12] = 0; // not interlaced
+    });
+
+    chunk("IDAT", zlib, [&](std::uint8_t* data) {
+        data[0] = 0x78; // deflate, 32k window
+        data[1] = 0x01; // no preset dictionary, fastest, check bits
+        stored_writer_t writer(data + 2, filtered);
+        constexpr std::uint8_t no_filter = {0};
+        for (std::size_t y = 0; y < rows; ++y) {
+            writer.write(&no_filter, 1);
+            writer.write(rgba.data() + y * stride, stride);
+        }
+        if (!filtered) {
+            // a final empty block all the same
+            std::memcpy(data + 2, "\x01\x00\x00\xff\xff", 5);
+        }
+        put_u32(data + zlib - 4, writer.adler());
+    });
+
+    chunk("IEND", 0, [](std::uint8_t*) {});
+    return result;
+}
+
+std::optional<std::vector<std::uint8_t>>
+capture_pool_t::acquire(
+    clock_t::time_point      now,
+    std::size_t              bytes,
+    std::chrono::nanoseconds frame_interval)
+{
+    const auto full = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        frame_interval * share);
+    const auto refill = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        (now - _refilled) * share);
+    _credit   = (_credit >= full - refill) ? full : _credit + refill;
+    _refilled = now;
+
+    const auto expected = std::chrono::nanoseconds(
+        static_cast<std::int64_t>(_ns_per_byte * static_cast<double>(bytes)));
+    if (_in_flight >= max_in_flight ||
+        (expected > _credit && _credit < full)) {
+        return std::nullopt;
+    }
+
+    ++_in_flight;
+    if (_free.empty()) {
+        return std::vector<std::uint8_t>();
+    }
+
+    auto buffer = std::move(_free.back());
+    _free.pop_back();
+    return buffer;
+}
+
+void
+capture_pool_t::spent(std::chrono::nanoseconds duration, std::size_t bytes)
+{
+    _credit -= duration;
+    if (bytes) {
+        // the estimate follows the latest read backs, the first one at once
+        const auto measured = static_cast<double>(duration.count()) /
+                              static_cast<double>(bytes);
+        _ns_per_byte = _ns_per_byte ? (_ns_per_byte * 3 + measured) / 4
+                                    : measured;
+    }
+}
+
+void
+capture_pool_t::release(std::vector<std::uint8_t>&& buffer)
+{
+    --_in_flight;
+    if (buffer.capacity() && _free.size() < max_in_flight) {
+        _free.push_back(std::move(buffer));
+    }
+}
+
+std::size_t
+capture_pool_t::in_flight() const
+{
+    return _in_flight;
+}
+}
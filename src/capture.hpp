@@ -0,0 +1,89 @@
+#pragma once
+#ifndef SK_IMPL_CAPTURE_HPP
+#define SK_IMPL_CAPTURE_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+struct SDL_Surface;
+
+namespace sk::impl {
+
+// where the channels of a 32-bit surface pixel are
+struct pixel_layout_t {
+    std::uint8_t r_shift = {16};
+    std::uint8_t g_shift = {8};
+    std::uint8_t b_shift = {0};
+    std::uint8_t a_shift = {24};
+    bool         alpha   = {false}; // opaque otherwise
+};
+
+/* copies the pixels of a 32-bit surface into the buffer, resized to
+ * 4 * width * height bytes; main thread, as SDL wants
+ */
+pixel_layout_t read_surface(SDL_Surface*, std::vector<std::uint8_t>& pixels);
+
+// surface pixels to 8-bit rgba in place, any thread
+void to_rgba(std::span<std::uint8_t> pixels, const pixel_layout_t&);
+
+/* a png of 8-bit rgba pixels: deflate blocks are stored rather than
+ * compressed and rows aren't filtered, encoding costs little more than a copy
+ * and two checksums
+ */
+std::vector<std::uint8_t>
+encode_png(std::span<const std::uint8_t> rgba, int width, int height);
+
+std::uint32_t crc32(std::span<const std::uint8_t>, std::uint32_t crc = 0);
+std::uint32_t adler32(std::span<const std::uint8_t>, std::uint32_t adler = 1);
+
+/* pixel buffers of captures being encoded, and the budget captures are read
+ * back within
+ *
+ * the main thread spends at most a share of its time reading captures back:
+ * every read back takes its measured duration off a credit that refills at
+ * that share of the time passing, up to the same share of a frame interval;
+ * a capture expected to cost more than the credit left is refused, or, if it
+ * costs more than the full credit, let through only once the credit is full
+ * so it's paid back over the next frames; too many captures still being
+ * encoded are refused as well
+ *
+ * main thread only, buffers come back through the application loop
+ */
+class capture_pool_t final {
+public:
+    using clock_t = std::chrono::steady_clock;
+
+    static constexpr double      share         = {0.25};
+    static constexpr std::size_t max_in_flight = {4};
+
+private:
+    std::vector<std::vector<std::uint8_t>> _free;
+    std::size_t                            _in_flight   = {0};
+    std::chrono::nanoseconds               _credit      = {
+        std::chrono::nanoseconds::max()}; // full, whatever that is
+    clock_t::time_point                    _refilled    = {clock_t::now()};
+    double                                 _ns_per_byte = {0.0};
+
+public:
+    /* a buffer for a capture of that many bytes, nullopt if it doesn't fit
+     * the budget
+     */
+    std::optional<std::vector<std::uint8_t>> acquire(
+        clock_t::time_point      now,
+        std::size_t              bytes,
+        std::chrono::nanoseconds frame_interval);
+
+    // a read back took that long
+    void spent(std::chrono::nanoseconds, std::size_t bytes);
+
+    // the capture is encoded, the buffer is reused unless it's empty
+    void release(std::vector<std::uint8_t>&&);
+
+    std::size_t in_flight() const;
+};
+}
+
+#endif // SK_IMPL_CAPTURE_HPP
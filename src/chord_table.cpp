@@ -0,0 +1,49 @@
+#include "chord_table.hpp"
+
+namespace sk::impl {
+
+std::size_t
+chord_table_t::row(const chord_t& chord)
+{
+    return static_cast<std::size_t>(chord.modifiers) *
+               keyboard_t::scancodes +
+           chord.scancode;
+}
+
+void
+chord_table_t::build(std::span<const entry_t> entries)
+{
+    _offsets.assign(rows + 1, 0);
+    for (const auto& entry : entries) {
+        ++_offsets[row(entry.chord) + 1];
+    }
+    for (std::size_t i = 1; i <= rows; ++i) {
+        _offsets[i] += _offsets[i - 1];
+    }
+
+    // every entry goes after those of its row placed so far
+    std::vector<std::uint32_t> next(_offsets.begin(), _offsets.end() - 1);
+    _slots.resize(entries.size());
+    for (const auto& entry : entries) {
+        _slots[next[row(entry.chord)]++] = entry.slot;
+    }
+}
+
+std::span<const std::uint32_t>
+chord_table_t::find(const chord_t& chord) const
+{
+    if (_offsets.empty()) {
+        return {};
+    }
+
+    const auto at = row(chord);
+    return std::span<const std::uint32_t>(_slots).subspan(
+        _offsets[at], _offsets[at + 1] - _offsets[at]);
+}
+
+std::size_t
+chord_table_t::size() const
+{
+    return _slots.size();
+}
+}
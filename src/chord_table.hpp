@@ -0,0 +1,43 @@
+#pragma once
+#ifndef SK_IMPL_CHORD_TABLE_HPP
+#define SK_IMPL_CHORD_TABLE_HPP
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <sketch/keyboard.hpp>
+
+namespace sk::impl {
+
+/* bindings by chord, as compressed rows: every combination of modifiers and
+ * scancode has a row of binding slots, the rows are laid out one after the
+ * other and found through a table of offsets; a lookup is two loads
+ * whatever the number of bindings, building is a counting sort
+ */
+class chord_table_t {
+public:
+    struct entry_t {
+        chord_t       chord;
+        std::uint32_t slot;
+    };
+
+    // rows, modifier combinations times scancodes
+    static constexpr std::size_t rows = {16 * keyboard_t::scancodes};
+
+    static std::size_t row(const chord_t&);
+
+private:
+    std::vector<std::uint32_t> _offsets; // per row, into _slots
+    std::vector<std::uint32_t> _slots;
+
+public:
+    // rows keep the order of the entries
+    void build(std::span<const entry_t>);
+
+    std::span<const std::uint32_t> find(const chord_t&) const;
+    std::size_t                    size() const;
+};
+}
+
+#endif // SK_IMPL_CHORD_TABLE_HPP
@@ -0,0 +1,116 @@
+#include "error_handler.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <ostream>
+
+namespace sk::impl {
+
+namespace {
+
+// utf-8 continuation bytes don't start a code point
+bool
+starts_code_point(char c)
+{
+    return (static_cast<unsigned char>(c) & 0xc0u) != 0x80u;
+}
+}
+
+error_handler_t::error_handler_t(
+    std::string_view input,
+    std::ostream&    out,
+    std::string      filename,
+    int              tabs)
+    : _input(input), _filename(std::move(filename)), _out(out), _tabs(tabs)
+{
+}
+
+// lines end with \n, \r\n or a lone \r
+const std::vector<std::size_t>&
+error_handler_t::line_starts() const
+{
+    if (!_line_starts.empty()) {
+        return _line_starts;
+    }
+
+    _line_starts.push_back(0);
+    for (std::size_t i = 0; i < _input.size(); ++i) {
+        if (_input[i] == '\n' ||
+            (_input[i] == '\r' &&
+             (i + 1 == _input.size() || _input[i + 1] != '\n'))) {
+            _line_starts.push_back(i + 1);
+        }
+    }
+    return _line_starts;
+}
+
+error_handler_t::location_t
+error_handler_t::location(const char* where) const
+{
+    const auto offset = static_cast<std::size_t>(std::clamp<std::ptrdiff_t>(
+        where - _input.data(), 0, static_cast<std::ptrdiff_t>(_input.size())));
+    const auto& starts = line_starts();
+    const auto  found  = std::upper_bound(starts.begin(), starts.end(), offset);
+    const auto  line   = static_cast<std::size_t>(found - starts.begin());
+    const auto start = starts[line - 1];
+    const auto text  = _input.substr(start, offset - start);
+
+    return {line,
+            1 + static_cast<std::size_t>(std::count_if(
+                    text.begin(), text.end(), starts_code_point))};
+}
+
+std::string_view
+error_handler_t::line(std::size_t line) const
+{
+    const auto& starts = line_starts();
+    if (!line || line > starts.size()) {
+        return {};
+    }
+
+    auto       result = _input.substr(starts[line - 1]);
+    const auto end    = result.find_first_of("\r\n");
+    return (end == std::string_view::npos) ? result : result.substr(0, end);
+}
+
+std::size_t
+error_handler_t::reported() const
+{
+    return _reported;
+}
+
+void
+error_handler_t::operator()(const char* where, std::string_view message) const
+{
+    ++_reported;
+
+    const auto* last = _input.data() + _input.size();
+    while (where < last && std::isspace(static_cast<unsigned char>(*where))) {
+        ++where;
+    }
+
+    const auto at = location(where);
+    _out << "In " << (_filename.empty() ? "" : "file " + _filename + ", ")
+         << "line " << at.line << ", column " << at.column << ":\n"
+         << message << '\n';
+
+    // the marker lines up with the text, tabs included
+    const auto text = line(at.line);
+    _out << text << '\n';
+    std::size_t column = 1;
+    for (auto c : text) {
+        if (column == at.column) {
+            break;
+        }
+
+        if (!starts_code_point(c)) {
+            continue;
+        }
+
+        const auto width = (c == '\t') ? static_cast<std::size_t>(_tabs) : 1;
+        _out << std::string(width, '_');
+        ++column;
+    }
+    _out << "^_" << std::endl;
+}
+}
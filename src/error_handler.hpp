@@ -2,13 +2,15 @@
 #ifndef SK_IMPL_ERROR_HANDLER_HPP
 #define SK_IMPL_ERROR_HANDLER_HPP
 
+#include <cstddef>
+#include <functional>
+#include <iosfwd>
 #include <string>
+#include <string_view>
+#include <vector>
 
 #include <boost/core/demangle.hpp>
-#include <boost/spirit/home/support/iterators/line_pos_iterator.hpp>
 #include <boost/spirit/home/x3.hpp>
-#include <boost/spirit/home/x3/support/ast/position_tagged.hpp>
-#include <boost/spirit/home/x3/support/utility/error_reporting.hpp>
 
 namespace sk::impl {
 
@@ -17,8 +19,45 @@ namespace x3 = boost::spirit::x3;
 // tag used to get our error handler from the context
 struct error_handler_tag;
 
-template <typename Iterator>
-using error_handler = typename x3::error_handler<Iterator>;
+/* reports parse errors along with the line they're at; the parser works on
+ * plain pointers into the input and nothing tracks lines while it runs, the
+ * line and column of a position are worked out from its offset only when
+ * something is reported, with an index of line starts built on first use
+ */
+class error_handler_t final {
+public:
+    struct location_t {
+        std::size_t line   = {1}; // 1-based
+        std::size_t column = {1}; // 1-based, in code points
+    };
+
+private:
+    std::string_view _input;
+    std::string      _filename;
+    std::ostream&    _out;
+    int              _tabs;
+
+    mutable std::size_t              _reported = {0};
+    mutable std::vector<std::size_t> _line_starts; // offsets, lazily
+
+    const std::vector<std::size_t>& line_starts() const;
+
+public:
+    error_handler_t(
+        std::string_view input,
+        std::ostream&    out,
+        std::string      filename = {},
+        int              tabs     = 4);
+
+    location_t       location(const char* where) const;
+    std::string_view line(std::size_t line) const; // without the line break
+    std::size_t      reported() const;               // messages so far
+
+    /* prints the message with the line it's about and a marker under the
+     * position, leading whitespace is skipped so that it marks a token
+     */
+    void operator()(const char* where, std::string_view message) const;
+};
 
 struct error_handler_base {
     template <typename Iterator, typename Exception, typename Context>
@@ -26,30 +65,29 @@ struct error_handler_base {
     on_error(
         Iterator&, Iterator const&, Exception const& x, Context const& context)
     {
-        std::string message = "error! expecting: " +
-                              boost::core::demangle(x.which().c_str()) +
-                              " here: ";
+        // rules enclosing the one that failed fail in turn, only the
+        // innermost says what's wrong
         auto& error_handler = x3::get<error_handler_tag>(context).get();
-        error_handler(x.where(), message);
+        if (!error_handler.reported()) {
+            error_handler(
+                x.where(),
+                "error! expecting: " +
+                    boost::core::demangle(x.which().c_str()) + " here: ");
+        }
         return x3::error_handler_result::fail;
     }
 };
 
-template <typename StringType>
-using iterator_t = typename boost::spirit::line_pos_iterator<
-    typename StringType::const_iterator>;
+using iterator_t = const char*;
 
 template <typename SpaceType>
 using phrase_context_t = typename x3::phrase_parse_context<SpaceType>::type;
 
-template <typename StringType>
-using error_handler_t = x3::error_handler<iterator_t<StringType>>;
-
-template <typename StringType, typename SpaceType>
-using context_t = typename x3::with_context<
+template <typename SpaceType>
+using context_t = x3::context<
     error_handler_tag,
-    std::reference_wrapper<error_handler_t<StringType>> const,
-    phrase_context_t<SpaceType>>::type;
+    std::reference_wrapper<error_handler_t>,
+    phrase_context_t<SpaceType>>;
 }
 
 #endif // SK_IMPL_ERROR_HANDLER_HPP
@@ -0,0 +1,326 @@
+#include "event_log.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <iterator>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include <SDL.h>
+
+namespace sk::impl {
+
+namespace {
+
+constexpr char          magic[4]  = {'S', 'K', 'E', 'V'};
+constexpr std::uint8_t  version   = {1};
+constexpr std::uint64_t no_window = {0};
+
+void
+put_varint(std::ostream& out, std::uint64_t value)
+{
+    while (value >= 0x80) {
+        out.put(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    out.put(static_cast<char>(value));
+}
+
+void
+put_signed(std::ostream& out, std::int64_t value)
+{
+    put_varint(
+        out,
+        (static_cast<std::uint64_t>(value) << 1) ^
+            static_cast<std::uint64_t>(value >> 63));
+}
+
+class reader_t {
+    const std::vector<std::uint8_t>& _log;
+    std::size_t&                     _cursor;
+
+public:
+    reader_t(const std::vector<std::uint8_t>& log, std::size_t& cursor)
+        : _log(log), _cursor(cursor)
+    {
+    }
+
+    std::uint8_t
+    byte()
+    {
+        if (_cursor >= _log.size()) {
+            throw std::runtime_error("truncated event log");
+        }
+        return _log[_cursor++];
+    }
+
+    std::uint64_t
+    varint()
+    {
+        std::uint64_t result = 0;
+        for (unsigned shift = 0; shift < 64; shift += 7) {
+            const auto b = byte();
+            result |= static_cast<std::uint64_t>(b & 0x7f) << shift;
+            if (!(b & 0x80)) {
+                return result;
+            }
+        }
+        throw std::runtime_error("malformed event log");
+    }
+
+    std::int64_t
+    signed_varint()
+    {
+        const auto value = varint();
+        return static_cast<std::int64_t>(value >> 1) ^
+               -static_cast<std::int64_t>(value & 1);
+    }
+
+    template <typename IntType>
+    IntType
+    get()
+    {
+        if constexpr (std::is_signed_v<IntType>) {
+            return static_cast<IntType>(signed_varint());
+        } else {
+            return static_cast<IntType>(varint());
+        }
+    }
+};
+
+template <typename DurationType>
+std::string
+format_duration(DurationType duration)
+{
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(1)
+        << std::chrono::duration<double, std::micro>(duration).count() << "us";
+    return out.str();
+}
+
+void
+print_percentiles(
+    std::ostream&                                      out,
+    std::string_view                                   what,
+    std::vector<std::chrono::steady_clock::duration> samples)
+{
+    out << what << ": " << samples.size() << " samples";
+    if (samples.empty()) {
+        out << '\n';
+        return;
+    }
+
+    std::sort(samples.begin(), samples.end());
+    const auto at = [&samples](double percentile) {
+        return samples[static_cast<std::size_t>(
+            percentile * static_cast<double>(samples.size() - 1))];
+    };
+    out << ", p50 " << format_duration(at(0.5)) << ", p95 "
+        << format_duration(at(0.95)) << ", p99 " << format_duration(at(0.99))
+        << ", max " << format_duration(samples.back()) << '\n';
+}
+}
+
+event_recorder_t::event_recorder_t(std::string_view filename)
+    : _file(std::string(filename), std::ios::binary | std::ios::trunc)
+{
+    if (!_file) {
+        throw std::runtime_error("failed to open event log for writing");
+    }
+
+    _file.write(magic, sizeof(magic));
+    _file.put(static_cast<char>(version));
+}
+
+void
+event_recorder_t::record(const SDL_Event& event, std::size_t window)
+{
+    switch (event.type) {
+    case SDL_QUIT:
+    case SDL_WINDOWEVENT:
+    case SDL_KEYDOWN:
+    case SDL_KEYUP:
+    case SDL_TEXTINPUT:
+    case SDL_MOUSEMOTION: break;
+    default: return;
+    }
+
+    const auto now = clock_t::now();
+    put_varint(
+        _file,
+        static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(now - _last)
+                .count()));
+    _last = now;
+    put_varint(_file, event.type == SDL_QUIT ? no_window : window + 1);
+    put_varint(_file, event.type);
+
+    switch (event.type) {
+    case SDL_WINDOWEVENT:
+        put_varint(_file, event.window.event);
+        put_signed(_file, event.window.data1);
+        put_signed(_file, event.window.data2);
+        break;
+    case SDL_KEYDOWN:
+    case SDL_KEYUP:
+        put_varint(
+            _file, static_cast<std::uint64_t>(event.key.keysym.scancode));
+        put_signed(_file, event.key.keysym.sym);
+        put_varint(_file, event.key.keysym.mod);
+        put_varint(_file, event.key.repeat);
+        break;
+    case SDL_TEXTINPUT: {
+        const auto length = std::strlen(event.text.text);
+        put_varint(_file, length);
+        _file.write(event.text.text, static_cast<std::streamsize>(length));
+    } break;
+    case SDL_MOUSEMOTION:
+        put_signed(_file, event.motion.x);
+        put_signed(_file, event.motion.y);
+        put_signed(_file, event.motion.xrel);
+        put_signed(_file, event.motion.yrel);
+        put_varint(_file, event.motion.state);
+        break;
+    default: break;
+    }
+}
+
+event_player_t::event_player_t(std::string_view filename, double speed)
+    : _speed(speed)
+{
+    if (speed <= 0) {
+        throw std::invalid_argument("replay speed must be positive");
+    }
+
+    std::ifstream file(std::string(filename), std::ios::binary);
+    if (!file) {
+        throw std::runtime_error("failed to open event log");
+    }
+
+    _log.assign(
+        std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    if (_log.size() < sizeof(magic) + 1 ||
+        !std::equal(std::begin(magic), std::end(magic), _log.begin()) ||
+        _log[sizeof(magic)] != version) {
+        throw std::runtime_error("not an event log");
+    }
+
+    _cursor = sizeof(magic) + 1;
+    read_offset();
+}
+
+void
+event_player_t::read_offset()
+{
+    if (_cursor == _log.size()) {
+        _done = true;
+        return;
+    }
+
+    // written unsigned, reading it as a signed type would zigzag-decode it
+    const auto delay = std::chrono::microseconds(
+        static_cast<std::chrono::microseconds::rep>(
+            reader_t(_log, _cursor).get<std::uint64_t>()));
+    _offset += std::chrono::duration_cast<clock_t::duration>(
+        std::chrono::duration<double, std::micro>(
+            static_cast<double>(delay.count()) / _speed));
+}
+
+void
+event_player_t::inject(clock_t::time_point now, const window_id_t& window_id)
+{
+    while (!_done && _start + _offset <= now) {
+        reader_t  read(_log, _cursor);
+        SDL_Event event = {};
+
+        const auto window = read.get<std::size_t>();
+        event.type        = read.get<Uint32>();
+
+        const auto id = (window == no_window) ? 0 : window_id(window - 1);
+        switch (event.type) {
+        case SDL_WINDOWEVENT:
+            event.window.windowID = id;
+            event.window.event    = read.get<Uint8>();
+            event.window.data1    = read.get<Sint32>();
+            event.window.data2    = read.get<Sint32>();
+            break;
+        case SDL_KEYDOWN:
+        case SDL_KEYUP:
+            event.key.windowID = id;
+            event.key.state =
+                (event.type == SDL_KEYDOWN) ? SDL_PRESSED : SDL_RELEASED;
+            event.key.keysym.scancode = read.get<SDL_Scancode>();
+            event.key.keysym.sym      = read.get<SDL_Keycode>();
+            event.key.keysym.mod      = read.get<Uint16>();
+            event.key.repeat          = read.get<Uint8>();
+            break;
+        case SDL_TEXTINPUT: {
+            event.text.windowID = id;
+            const auto length   = read.get<std::size_t>();
+            // the recorder never writes more, skipping the rest would desync
+            if (length >= SDL_TEXTINPUTEVENT_TEXT_SIZE) {
+                throw std::runtime_error("malformed event log");
+            }
+            for (std::size_t i = 0; i < length; ++i) {
+                event.text.text[i] = static_cast<char>(read.byte());
+            }
+        } break;
+        case SDL_MOUSEMOTION:
+            event.motion.windowID = id;
+            event.motion.x        = read.get<Sint32>();
+            event.motion.y        = read.get<Sint32>();
+            event.motion.xrel     = read.get<Sint32>();
+            event.motion.yrel     = read.get<Sint32>();
+            event.motion.state    = read.get<Uint32>();
+            break;
+        default: break;
+        }
+
+        // events of windows that don't exist in this run are dropped
+        if (window == no_window || id) {
+            if (SDL_PushEvent(&event) < 0) {
+                throw std::runtime_error(SDL_GetError());
+            }
+            ++_injected;
+        }
+
+        read_offset();
+    }
+}
+
+bool
+event_player_t::finished() const
+{
+    return _done;
+}
+
+event_player_t::clock_t::time_point
+event_player_t::next_deadline() const
+{
+    return _done ? clock_t::time_point::max() : _start + _offset;
+}
+
+void
+event_player_t::measure_event(clock_t::duration reactor_latency)
+{
+    _latencies.push_back(reactor_latency);
+}
+
+void
+event_player_t::measure_frame(clock_t::duration frame_time)
+{
+    _frame_times.push_back(frame_time);
+}
+
+void
+event_player_t::report(std::ostream& out) const
+{
+    out << "replayed " << _injected << " events at " << _speed << "x in "
+        << format_duration(clock_t::now() - _start) << '\n';
+    print_percentiles(out, "reactor latency", _latencies);
+    print_percentiles(out, "frame time", _frame_times);
+}
+}
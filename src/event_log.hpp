@@ -0,0 +1,77 @@
+#pragma once
+#ifndef SK_IMPL_EVENT_LOG_HPP
+#define SK_IMPL_EVENT_LOG_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <iosfwd>
+#include <string_view>
+#include <vector>
+
+union SDL_Event;
+
+namespace sk::impl {
+
+/* binary log of the input each window received: a "SKEV" magic and a format
+ * version, then one record per event made of the microseconds since the
+ * previous record, the window's position within the application (plus one,
+ * zero for application-wide events), the SDL event type and a type-specific
+ * payload; integers are LEB128 varints, signed ones zigzag-encoded
+ */
+class event_recorder_t {
+    using clock_t = std::chrono::steady_clock;
+
+    std::ofstream       _file;
+    clock_t::time_point _last = {clock_t::now()};
+
+public:
+    explicit event_recorder_t(std::string_view filename);
+
+    // events of types the application doesn't handle are skipped
+    void record(const SDL_Event&, std::size_t window);
+};
+
+/* injects a recorded log into the SDL event queue, at the original pace or
+ * scaled by speed, and measures how the application copes with it
+ */
+class event_player_t {
+public:
+    using clock_t = std::chrono::steady_clock;
+
+    // SDL window id of the window at a given position, zero if there's none
+    using window_id_t = std::function<std::uint32_t(std::size_t window)>;
+
+private:
+    std::vector<std::uint8_t> _log;
+    std::size_t               _cursor   = {0};
+    double                    _speed    = {1.0};
+    clock_t::time_point       _start    = {clock_t::now()};
+    clock_t::duration         _offset   = {clock_t::duration::zero()};
+    bool                      _done     = {false};
+    std::size_t               _injected = {0};
+
+    std::vector<clock_t::duration> _latencies;
+    std::vector<clock_t::duration> _frame_times;
+
+    void read_offset();
+
+public:
+    event_player_t(std::string_view filename, double speed);
+
+    // pushes every event that is due by now
+    void inject(clock_t::time_point now, const window_id_t&);
+    bool finished() const;
+
+    clock_t::time_point next_deadline() const;
+
+    void measure_event(clock_t::duration reactor_latency);
+    void measure_frame(clock_t::duration frame_time);
+
+    // prints latency and frame time percentiles
+    void report(std::ostream&) const;
+};
+}
+
+#endif // SK_IMPL_EVENT_LOG_HPP
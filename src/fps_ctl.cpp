@@ -1,6 +1,6 @@
 #include "fps_ctl.hpp"
 
-#include <thread>
+#include <algorithm>
 
 using namespace std::chrono_literals;
 
@@ -9,20 +9,27 @@ namespace sk::impl {
 namespace {
 
 constexpr std::size_t etalon_fps = {60};
+
+// input is polled at least this often, whatever the deadlines are
+constexpr auto poll_interval =
+    std::chrono::duration_cast<std::chrono::steady_clock::duration>(1s) /
+    etalon_fps;
 }
 
-void
-fps_ctl_t::update()
+std::chrono::steady_clock::time_point
+fps_ctl_t::update(
+    bool presented, std::chrono::steady_clock::time_point deadline)
 {
-    ++_frames;
+    _frames += presented;
     auto now = std::chrono::steady_clock::now();
     if (now - _last_update_time >= 1s) {
         _current_fps      = _frames;
         _frames           = 0;
         _last_update_time = now;
-        _sleep_duration += (_current_fps > etalon_fps) ? 1ms : -1ms;
     }
-    std::this_thread::sleep_for(_sleep_duration);
+
+    return std::min<std::chrono::steady_clock::time_point>(
+        deadline, now + poll_interval);
 }
 
 std::size_t
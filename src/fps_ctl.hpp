@@ -11,11 +11,19 @@ class fps_ctl_t {
     std::size_t                           _frames           = {0};
     std::chrono::steady_clock::time_point _last_update_time = {
         std::chrono::steady_clock::now()};
-    std::chrono::milliseconds _sleep_duration = {
-        std::chrono::milliseconds::zero()};
 
 public:
-    void        update();
+    /* counts a loop iteration that presented a frame, i.e. drew at least one
+     * window, and tells when the loop has to wake up: at the deadline, but no
+     * later than the input polling interval
+     */
+    std::chrono::steady_clock::time_point
+    update(
+        bool                                  presented,
+        std::chrono::steady_clock::time_point deadline =
+            std::chrono::steady_clock::time_point::max());
+
+    // frames presented over the last second, idle wakeups aren't counted
     std::size_t get_fps() const;
 };
 }
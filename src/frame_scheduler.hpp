@@ -0,0 +1,82 @@
+#pragma once
+#ifndef SK_IMPL_FRAME_SCHEDULER_HPP
+#define SK_IMPL_FRAME_SCHEDULER_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace sk::impl {
+
+/* min-heap of per-window frame deadlines, only windows whose deadline has
+ * arrived are serviced; entries carry the window's epoch so rescheduling
+ * simply leaves the outdated entry behind to be dropped when it surfaces
+ */
+class frame_scheduler_t {
+public:
+    using clock_t = std::chrono::steady_clock;
+
+private:
+    struct entry_t {
+        clock_t::time_point deadline;
+        std::uint64_t       key;
+        std::uint64_t       epoch;
+
+        bool
+        operator>(const entry_t& other) const
+        {
+            return deadline > other.deadline;
+        }
+    };
+
+    std::vector<entry_t> _heap;
+
+public:
+    void
+    schedule(std::uint64_t key, std::uint64_t epoch, clock_t::time_point at)
+    {
+        _heap.push_back({at, key, epoch});
+        std::push_heap(_heap.begin(), _heap.end(), std::greater<>());
+    }
+
+    /* service is called as service(key, epoch, deadline) for every due
+     * entry and returns the next deadline of that window, or nothing if the
+     * entry is outdated
+     */
+    template <typename FuncType>
+    void
+    run_due(clock_t::time_point now, FuncType&& service)
+    {
+        while (!_heap.empty() && _heap.front().deadline <= now) {
+            std::pop_heap(_heap.begin(), _heap.end(), std::greater<>());
+            const auto entry = _heap.back();
+            _heap.pop_back();
+
+            const std::optional<clock_t::time_point> next =
+                service(entry.key, entry.epoch, entry.deadline);
+            if (next) {
+                schedule(entry.key, entry.epoch, *next);
+            }
+        }
+    }
+
+    // outdated entries included
+    std::size_t
+    size() const
+    {
+        return _heap.size();
+    }
+
+    // may be earlier than needed when the top entry is outdated
+    clock_t::time_point
+    next_deadline() const
+    {
+        return _heap.empty() ? clock_t::time_point::max()
+                             : _heap.front().deadline;
+    }
+};
+}
+
+#endif // SK_IMPL_FRAME_SCHEDULER_HPP
@@ -0,0 +1,93 @@
+#pragma once
+#ifndef SK_IMPL_GRAMMAR_HPP
+#define SK_IMPL_GRAMMAR_HPP
+
+#include <type_traits>
+
+#include <boost/spirit/home/x3.hpp>
+
+#include "error_handler.hpp"
+#include "sketch_ast.hpp"
+
+namespace sk::impl::grammar {
+
+namespace x3 = boost::spirit::x3;
+
+/* the grammar is split into groups of rules, every group is defined and
+ * instantiated in a translation unit of its own (grammar_*.cpp) for exactly
+ * the iterator and context below, so a change to one group recompiles only
+ * that group; rules used across groups are declared here
+ */
+
+// input is utf-8, bytes of multibyte sequences mustn't be classified
+inline const auto skipper = x3::rule<struct skipper_tag>("skipper") =
+    x3::char_(" \t\n\v\f\r") | "/*" >> *(x3::char_ - "*/") >> "*/" |
+    "//" >> *(x3::char_ - x3::eol - x3::eoi);
+
+using iterator_t = impl::iterator_t;
+using skipper_t  = std::remove_const_t<decltype(skipper)>;
+using context_t  = impl::context_t<skipper_t>;
+
+// keywords don't match the start of a longer name, e.g. centered_x
+inline auto
+keyword(const char* word)
+{
+    return x3::lexeme[x3::lit(word) >> !x3::char_("a-zA-Z0-9_")];
+}
+
+/* matches nothing, its attribute is where the next token starts; the range
+ * semantic actions get starts past what they matched, so positions are taken
+ * with (here >> subject)[...], see where_of and operand_of
+ */
+struct here_tag;
+inline const auto here = x3::rule<here_tag, iterator_t>("here") =
+    x3::eps[([](auto& ctx) { x3::_val(ctx) = x3::_where(ctx).begin(); })];
+
+template <typename Context>
+iterator_t
+where_of(const Context& ctx)
+{
+    return boost::fusion::at_c<0>(x3::_attr(ctx));
+}
+
+template <typename Context>
+auto&
+operand_of(const Context& ctx)
+{
+    return boost::fusion::at_c<1>(x3::_attr(ctx));
+}
+
+struct attribute_tag : error_handler_base {
+};
+struct expression_tag : error_handler_base {
+};
+struct definition_tag : error_handler_base {
+};
+struct file_tag : error_handler_base {
+};
+
+using attribute_rule_t  = x3::rule<attribute_tag, attribute_t>;
+using expression_rule_t = x3::rule<expression_tag, expression_ast>;
+using definition_rule_t = x3::rule<definition_tag, definition_ast>;
+using file_rule_t       = x3::rule<file_tag, file_ast>;
+
+// width, height, position or fullscreen, see grammar_attribute.cpp
+inline constexpr attribute_rule_t attribute("attribute");
+
+// arithmetic over lengths and names, see grammar_expression.cpp
+inline constexpr expression_rule_t expression("expression");
+
+// let name = expression, see grammar_expression.cpp
+inline constexpr definition_rule_t definition("definition");
+
+// a whole file: includes, definitions and the window, see grammar_region.cpp
+inline constexpr file_rule_t file("file");
+
+BOOST_SPIRIT_DECLARE(
+    attribute_rule_t,
+    expression_rule_t,
+    definition_rule_t,
+    file_rule_t)
+}
+
+#endif // SK_IMPL_GRAMMAR_HPP
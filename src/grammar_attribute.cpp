@@ -0,0 +1,75 @@
+#include "grammar.hpp"
+
+namespace sk::impl::grammar {
+
+namespace {
+
+// values are alternatives, whichever matched is assigned
+const auto assign = [](auto& ctx) { x3::_val(ctx) = x3::_attr(ctx); };
+
+struct centered_tag : impl::error_handler_base {
+};
+auto centered = x3::rule<centered_tag, bool>("centered") =
+    keyword("centered")[([](auto& ctx) { x3::_val(ctx) = true; })];
+
+struct full_tag : impl::error_handler_base {
+};
+auto full = x3::rule<full_tag, bool>{"full"} =
+    keyword("full")[([](auto& ctx) { x3::_val(ctx) = true; })];
+
+/* rules leading to expressions, which are defined in a group of their own,
+ * are defined with BOOST_SPIRIT_DEFINE, so that they're parsed with the very
+ * context the expressions are instantiated for
+ */
+struct width_tag : impl::error_handler_base {
+};
+const auto width     = x3::rule<width_tag, width_t>{"width"};
+const auto width_def = x3::lit("width") > '=' >
+                       (full[assign] | expression[assign]);
+
+struct height_tag : impl::error_handler_base {
+};
+const auto height     = x3::rule<height_tag, height_t>{"height"};
+const auto height_def = x3::lit("height") > '=' >
+                        (full[assign] | expression[assign]);
+
+struct horizontal_tag : impl::error_handler_base {
+};
+const auto horizontal = x3::rule<horizontal_tag, horizontal_t>{"horizontal"};
+const auto horizontal_def = centered[assign] | expression[assign];
+
+struct vertical_tag : impl::error_handler_base {
+};
+const auto vertical     = x3::rule<vertical_tag, vertical_t>{"vertical"};
+const auto vertical_def = centered[assign] | expression[assign];
+
+struct point_tag : impl::error_handler_base {
+};
+const auto point     = x3::rule<point_tag, point_t>{"point"};
+const auto point_def = x3::lit("position") > '=' >
+    horizontal[([](auto& ctx) { x3::_val(ctx).first = x3::_attr(ctx); })] >
+    ',' > vertical[([](auto& ctx) { x3::_val(ctx).second = x3::_attr(ctx); })];
+
+struct position_tag : impl::error_handler_base {
+};
+const auto position     = x3::rule<position_tag, position_t>{"position"};
+const auto position_def = centered | point;
+
+BOOST_SPIRIT_DEFINE(width, height, horizontal, vertical, point, position)
+
+struct fullscreen_tag : impl::error_handler_base {
+};
+auto fullscreen = x3::rule<fullscreen_tag, fullscreen_t>{"fullscreen"} =
+    x3::lit("fullscreen")[([](auto& ctx) { x3::_val(ctx) = true; })];
+}
+
+const auto attribute_def =
+    width[([](auto& ctx) { std::get<0>(x3::_val(ctx)) = x3::_attr(ctx); })] |
+    height[([](auto& ctx) { std::get<1>(x3::_val(ctx)) = x3::_attr(ctx); })] |
+    position[([](auto& ctx) { std::get<2>(x3::_val(ctx)) = x3::_attr(ctx); })] |
+    fullscreen[(
+        [](auto& ctx) { std::get<3>(x3::_val(ctx)) = x3::_attr(ctx); })];
+
+BOOST_SPIRIT_DEFINE(attribute)
+BOOST_SPIRIT_INSTANTIATE(attribute_rule_t, iterator_t, context_t)
+}
@@ -0,0 +1,100 @@
+#include "grammar.hpp"
+
+namespace sk::impl::grammar {
+
+namespace {
+
+using op_t = expression_ast::op_t;
+
+// appends the operand and then the operator, postfix order
+template <op_t Op>
+const auto apply = [](auto& ctx) {
+    x3::_val(ctx).append(std::move(operand_of(ctx)));
+    x3::_val(ctx).apply(Op, where_of(ctx));
+};
+
+const auto append = [](auto& ctx) {
+    x3::_val(ctx).append(std::move(x3::_attr(ctx)));
+};
+
+struct name_tag : impl::error_handler_base {
+};
+auto name = x3::rule<name_tag, std::string>("name") =
+    x3::lexeme[x3::char_("a-zA-Z_") >> *x3::char_("a-zA-Z0-9_")];
+
+// 12, 12px or 12%, units follow numbers immediately; bare numbers scale
+struct literal_tag : impl::error_handler_base {
+};
+auto literal = x3::rule<literal_tag, expression_ast>("literal") =
+    (here >> x3::double_)[([](auto& ctx) {
+        x3::_val(ctx).nodes.push_back(
+            {op_t::number, operand_of(ctx), {}, where_of(ctx)});
+    })] >>
+    x3::no_skip[-(
+        x3::lit('%')[(
+            [](auto& ctx) { x3::_val(ctx).nodes.back().op = op_t::percent; })] |
+        x3::lit("px")[(
+            [](auto& ctx) { x3::_val(ctx).nodes.back().op = op_t::pixels; })])];
+
+/* the rules below lead back to expression, they're defined with
+ * BOOST_SPIRIT_DEFINE so that none of them adds itself to the context;
+ * names come first, so that inf and nan are names rather than numbers
+ */
+struct primary_tag : impl::error_handler_base {
+};
+const auto primary     = x3::rule<primary_tag, expression_ast>("primary");
+const auto primary_def =
+    (here >> name)[([](auto& ctx) {
+        x3::_val(ctx).nodes.push_back(
+            {op_t::name, 0, operand_of(ctx), where_of(ctx)});
+    })] |
+    literal[append] | ('(' > expression[append] > ')');
+
+struct unary_tag : impl::error_handler_base {
+};
+const auto unary     = x3::rule<unary_tag, expression_ast>("unary");
+// signs are collected rather than recursed into, -----1px costs no stack
+const auto unary_def = (*(here >> '-') >> primary)[([](auto& ctx) {
+    const auto& signs = boost::fusion::at_c<0>(x3::_attr(ctx));
+    x3::_val(ctx).append(std::move(operand_of(ctx)));
+    for (auto sign = signs.rbegin(); sign != signs.rend(); ++sign) {
+        x3::_val(ctx).apply(op_t::negate, *sign);
+    }
+})];
+
+struct multiplicative_tag : impl::error_handler_base {
+};
+const auto multiplicative =
+    x3::rule<multiplicative_tag, expression_ast>("multiplicative");
+const auto multiplicative_def =
+    unary[append] >> *((here >> '*' > unary)[apply<op_t::multiply>] |
+                       (here >> '/' > unary)[apply<op_t::divide>]);
+
+struct additive_tag : impl::error_handler_base {
+};
+const auto additive     = x3::rule<additive_tag, expression_ast>("additive");
+const auto additive_def =
+    multiplicative[append] >>
+    *((here >> '+' > multiplicative)[apply<op_t::add>] |
+      (here >> '-' > multiplicative)[apply<op_t::subtract>]);
+
+BOOST_SPIRIT_DEFINE(primary, unary, multiplicative, additive)
+}
+
+// the text is kept for printing, e.g. width = 50% - 2 * gutter
+const auto expression_def = (here >> additive)[([](auto& ctx) {
+    x3::_val(ctx) = std::move(operand_of(ctx));
+    x3::_val(ctx).text.assign(where_of(ctx), x3::_where(ctx).begin());
+})];
+
+const auto definition_def =
+    keyword("let") > (here >> name)[([](auto& ctx) {
+        x3::_val(ctx).name  = operand_of(ctx);
+        x3::_val(ctx).where = where_of(ctx);
+    })] > '=' >
+    expression[([](auto& ctx) { x3::_val(ctx).value = x3::_attr(ctx); })];
+
+BOOST_SPIRIT_DEFINE(expression, definition)
+BOOST_SPIRIT_INSTANTIATE(expression_rule_t, iterator_t, context_t)
+BOOST_SPIRIT_INSTANTIATE(definition_rule_t, iterator_t, context_t)
+}
@@ -0,0 +1,116 @@
+#include "grammar.hpp"
+
+#include <utility>
+
+namespace sk::impl::grammar {
+
+namespace {
+
+struct line_ending_tag : impl::error_handler_base {
+};
+auto line_ending = x3::rule<line_ending_tag>("line_ending") =
+    x3::no_skip[x3::skip(skipper - x3::eol)[x3::eol]];
+
+struct single_quoted_string_tag : impl::error_handler_base {
+};
+auto single_quoted_string =
+    x3::rule<single_quoted_string_tag, std::string>("single_quoted_string") =
+        '\'' >> x3::lexeme[*(~x3::char_('\''))] >> '\'';
+
+struct double_quoted_string_tag : impl::error_handler_base {
+};
+auto double_quoted_string =
+    x3::rule<double_quoted_string_tag, std::string>("double_quoted_string") =
+        '"' >> x3::lexeme[*(~x3::char_('"'))] >> '"';
+
+struct quoted_string_tag : impl::error_handler_base {
+};
+auto quoted_string = x3::rule<quoted_string_tag, std::string>("quoted_string") =
+    single_quoted_string | double_quoted_string;
+
+struct title_tag : impl::error_handler_base {
+};
+auto title = x3::rule<title_tag, std::string>("title") = quoted_string;
+
+// attributes can be rejected, e.g. a width for a fullscreen window
+const auto set_attribute = [](auto& ctx) {
+    const auto why = x3::_val(ctx).set_attribute(operand_of(ctx));
+    x3::_pass(ctx) = why.empty();
+    if (!x3::_pass(ctx)) {
+        x3::get<error_handler_tag>(ctx).get()(
+            where_of(ctx), "error! " + why + " here: ");
+    }
+};
+
+struct element_kind_tag : impl::error_handler_base {
+};
+auto element_kind = x3::rule<element_kind_tag, element_kind_t>(
+                        "element_kind") =
+    x3::lit("panel")[(
+        [](auto& ctx) { x3::_val(ctx) = element_kind_t::panel; })] |
+    x3::lit("label")[(
+        [](auto& ctx) { x3::_val(ctx) = element_kind_t::label; })] |
+    x3::lit("rect")[([](auto& ctx) { x3::_val(ctx) = element_kind_t::rect; })];
+
+/* nested elements, e.g.
+ *
+ *     panel = 'toolbar' {
+ *         height = 10%
+ *         label = 'ok' {
+ *             position = centered
+ *         }
+ *     }
+ */
+struct element_tag : impl::error_handler_base {
+};
+const auto element = x3::rule<element_tag, region_ast>("element");
+const auto element_def =
+    element_kind[([](auto& ctx) { x3::_val(ctx).set_kind(x3::_attr(ctx)); })] >>
+    -('=' >
+      title[([](auto& ctx) { x3::_val(ctx).set_title(x3::_attr(ctx)); })]) >>
+    -('{' > *(line_ending >>
+              ((here >> attribute)[set_attribute] |
+               element[([](auto& ctx) {
+                   // moved rather than copied, nested levels would copy their
+                   // whole subtree each
+                   x3::_val(ctx).add_child(std::move(x3::_attr(ctx)));
+               })])) > '}');
+BOOST_SPIRIT_DEFINE(element)
+
+struct window_tag : impl::error_handler_base {
+};
+const auto window = x3::rule<window_tag, region_ast>("window");
+const auto window_def =
+    x3::lit("window") > '=' >
+    title[([](auto& ctx) { x3::_val(ctx).set_title(x3::_attr(ctx)); })] > ':' >
+    +(line_ending >>
+      ((here >> attribute)[set_attribute] | element[([](auto& ctx) {
+           x3::_val(ctx).add_child(std::move(x3::_attr(ctx)));
+       })]));
+
+BOOST_SPIRIT_DEFINE(window)
+
+// include 'common.sketch'
+struct include_tag : impl::error_handler_base {
+};
+auto include = x3::rule<include_tag, include_ast>("include") =
+    keyword("include") > (here >> quoted_string)[([](auto& ctx) {
+        x3::_val(ctx).path  = operand_of(ctx);
+        x3::_val(ctx).where = where_of(ctx);
+    })];
+}
+
+const auto file_def =
+    *(include[([](auto& ctx) {
+          x3::_val(ctx).includes.push_back(x3::_attr(ctx));
+      })] |
+      definition[([](auto& ctx) {
+          x3::_val(ctx).definitions.push_back(x3::_attr(ctx));
+      })]) >>
+    -window[([](auto& ctx) {
+        x3::_val(ctx).window = std::move(x3::_attr(ctx));
+    })];
+
+BOOST_SPIRIT_DEFINE(file)
+BOOST_SPIRIT_INSTANTIATE(file_rule_t, iterator_t, context_t)
+}
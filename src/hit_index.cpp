@@ -0,0 +1,331 @@
+#include "hit_index.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <numeric>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define SK_HIT_INDEX_AVX2
+#include <immintrin.h>
+#endif
+
+namespace sk::impl {
+
+namespace {
+
+// about this many entries per cell, with no more cells than this
+constexpr std::size_t entries_per_cell = {16};
+constexpr std::size_t max_cells        = {64 * 64};
+constexpr int         min_cell_size    = {8};
+
+/* a rectangle goes to the finest level it spans at most this many cells of
+ * across, plus one for where it straddles cell edges; keeping rectangles in
+ * few levels keeps queries from looking at many
+ */
+constexpr int level_span = {4};
+
+struct boxes_t {
+    const std::int32_t* left;
+    const std::int32_t* top;
+    const std::int32_t* right;
+    const std::int32_t* bottom;
+};
+
+// index of the last box containing the point, -1 if there's none
+using kernel_t = std::ptrdiff_t (*)(const boxes_t&, std::size_t, int, int);
+
+bool
+contains(const boxes_t& boxes, std::size_t i, int x, int y)
+{
+    return boxes.left[i] <= x && x < boxes.right[i] && boxes.top[i] <= y &&
+           y < boxes.bottom[i];
+}
+
+[[maybe_unused]] std::ptrdiff_t
+last_hit_scalar(const boxes_t& boxes, std::size_t count, int x, int y)
+{
+    for (auto i = count; i > 0; --i) {
+        if (contains(boxes, i - 1, x, y)) {
+            return static_cast<std::ptrdiff_t>(i - 1);
+        }
+    }
+    return -1;
+}
+
+#if defined(__SSE2__)
+std::ptrdiff_t
+last_hit_sse2(const boxes_t& boxes, std::size_t count, int x, int y)
+{
+    constexpr std::size_t lanes = {4};
+
+    // scanning backwards, the boxes that don't fill a register come first
+    auto i = count;
+    while (i % lanes) {
+        if (contains(boxes, --i, x, y)) {
+            return static_cast<std::ptrdiff_t>(i);
+        }
+    }
+
+    const auto px   = _mm_set1_epi32(x);
+    const auto py   = _mm_set1_epi32(y);
+    const auto load = [](const std::int32_t* from) {
+        return _mm_loadu_si128(reinterpret_cast<const __m128i*>(from));
+    };
+    while (i) {
+        i -= lanes;
+        const auto inside = _mm_and_si128(
+            _mm_andnot_si128(
+                _mm_cmpgt_epi32(load(boxes.left + i), px),
+                _mm_cmpgt_epi32(load(boxes.right + i), px)),
+            _mm_andnot_si128(
+                _mm_cmpgt_epi32(load(boxes.top + i), py),
+                _mm_cmpgt_epi32(load(boxes.bottom + i), py)));
+        const auto mask = static_cast<unsigned>(
+            _mm_movemask_ps(_mm_castsi128_ps(inside)));
+        if (mask) {
+            return static_cast<std::ptrdiff_t>(i) + 31 - __builtin_clz(mask);
+        }
+    }
+    return -1;
+}
+#endif
+
+#if defined(SK_HIT_INDEX_AVX2)
+__attribute__((target("avx2"))) __m256i
+load(const std::int32_t* from)
+{
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(from));
+}
+
+__attribute__((target("avx2"))) std::ptrdiff_t
+last_hit_avx2(const boxes_t& boxes, std::size_t count, int x, int y)
+{
+    constexpr std::size_t lanes = {8};
+
+    auto i = count;
+    while (i % lanes) {
+        if (contains(boxes, --i, x, y)) {
+            return static_cast<std::ptrdiff_t>(i);
+        }
+    }
+
+    const auto px = _mm256_set1_epi32(x);
+    const auto py = _mm256_set1_epi32(y);
+    while (i) {
+        i -= lanes;
+        const auto inside = _mm256_and_si256(
+            _mm256_andnot_si256(
+                _mm256_cmpgt_epi32(load(boxes.left + i), px),
+                _mm256_cmpgt_epi32(load(boxes.right + i), px)),
+            _mm256_andnot_si256(
+                _mm256_cmpgt_epi32(load(boxes.top + i), py),
+                _mm256_cmpgt_epi32(load(boxes.bottom + i), py)));
+        const auto mask = static_cast<unsigned>(
+            _mm256_movemask_ps(_mm256_castsi256_ps(inside)));
+        if (mask) {
+            return static_cast<std::ptrdiff_t>(i) + 31 - __builtin_clz(mask);
+        }
+    }
+    return -1;
+}
+#endif
+
+struct kernel_info_t {
+    kernel_t         find;
+    std::string_view isa;
+};
+
+const kernel_info_t&
+kernel()
+{
+    static const kernel_info_t selected = [] {
+#if defined(SK_HIT_INDEX_AVX2)
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) {
+            return kernel_info_t{last_hit_avx2, "avx2"};
+        }
+#endif
+#if defined(__SSE2__)
+        return kernel_info_t{last_hit_sse2, "sse2"};
+#else
+        return kernel_info_t{last_hit_scalar, "scalar"};
+#endif
+    }();
+    return selected;
+}
+}
+
+void
+hit_index_t::build(
+    std::span<const int> x,
+    std::span<const int> y,
+    std::span<const int> w,
+    std::span<const int> h,
+    int                  width,
+    int                  height)
+{
+    _width  = std::max(width, 0);
+    _height = std::max(height, 0);
+
+    // the finest cells are sized for uniformly spread small rectangles
+    const auto cells = std::clamp<std::size_t>(
+        x.size() / entries_per_cell, std::size_t{1}, max_cells);
+    const auto area =
+        static_cast<double>(_width) * static_cast<double>(_height);
+    auto cell_size = std::max(
+        min_cell_size,
+        static_cast<int>(
+            std::ceil(std::sqrt(area / static_cast<double>(cells)))));
+
+    // coarser levels up to one whose single cell covers the window
+    _levels.clear();
+    std::size_t first_cell = 0;
+    while (true) {
+        level_t level;
+        level.cell_size  = cell_size;
+        level.columns    = (_width + cell_size - 1) / cell_size;
+        level.rows       = (_height + cell_size - 1) / cell_size;
+        level.first_cell = first_cell;
+        first_cell += static_cast<std::size_t>(level.columns * level.rows);
+        _levels.push_back(level);
+        if (cell_size >= std::max(_width, _height)) {
+            break;
+        }
+        cell_size *= 2;
+    }
+
+    // calls visit(cell, left, top, right, bottom) for every cell of its level
+    // the i-th rectangle overlaps, once clipped to the window
+    const auto for_each_cell = [&](std::size_t i, auto&& visit) {
+        const auto left   = std::max(x[i], 0);
+        const auto top    = std::max(y[i], 0);
+        const auto right  = std::min(x[i] + std::max(w[i], 0), _width);
+        const auto bottom = std::min(y[i] + std::max(h[i], 0), _height);
+        if (left >= right || top >= bottom) {
+            return;
+        }
+
+        const auto size  = std::max(right - left, bottom - top);
+        auto       level = _levels.begin();
+        while (level->cell_size * level_span < size) {
+            ++level; // the last level fits any clipped rectangle
+        }
+
+        const auto cell = level->cell_size;
+        for (auto row = top / cell; row <= (bottom - 1) / cell; ++row) {
+            for (auto column = left / cell; column <= (right - 1) / cell;
+                 ++column) {
+                visit(
+                    *level,
+                    level->first_cell +
+                        static_cast<std::size_t>(row * level->columns + column),
+                    left,
+                    top,
+                    right,
+                    bottom);
+            }
+        }
+    };
+
+    // count entries per cell, then lay cells out back to back
+    _offsets.assign(first_cell + 1, 0);
+    for (std::size_t i = 0; i < x.size(); ++i) {
+        for_each_cell(
+            i, [this](level_t& level, std::size_t cell, int, int, int, int) {
+                ++level.entries;
+                ++_offsets[cell + 1];
+            });
+    }
+    std::partial_sum(_offsets.begin(), _offsets.end(), _offsets.begin());
+
+    const auto total = _offsets.back();
+    _left.resize(total);
+    _top.resize(total);
+    _right.resize(total);
+    _bottom.resize(total);
+    _ids.resize(total);
+
+    // elements go in in scene order, so every cell is sorted by element
+    auto cursor = _offsets;
+    for (std::size_t i = 0; i < x.size(); ++i) {
+        for_each_cell(
+            i,
+            [this, &cursor, i](
+                level_t&,
+                std::size_t cell,
+                int         left,
+                int         top,
+                int         right,
+                int         bottom) {
+                const auto at = cursor[cell]++;
+                _left[at]     = left;
+                _top[at]      = top;
+                _right[at]    = right;
+                _bottom[at]   = bottom;
+                _ids[at]      = static_cast<std::uint32_t>(i);
+            });
+    }
+}
+
+std::uint32_t
+hit_index_t::find(int x, int y) const
+{
+    if (x < 0 || y < 0 || x >= _width || y >= _height) {
+        return npos;
+    }
+
+    // every level may hold the topmost hit, later elements win
+    auto hit = npos;
+    for (const auto& level : _levels) {
+        if (!level.entries) {
+            continue;
+        }
+
+        const auto cell =
+            level.first_cell +
+            static_cast<std::size_t>(
+                (y / level.cell_size) * level.columns + x / level.cell_size);
+        auto       begin = std::size_t{_offsets[cell]};
+        const auto end   = std::size_t{_offsets[cell + 1]};
+        if (hit != npos) {
+            // only elements above the hit so far are of interest
+            begin = static_cast<std::size_t>(
+                std::upper_bound(
+                    _ids.begin() + static_cast<std::ptrdiff_t>(begin),
+                    _ids.begin() + static_cast<std::ptrdiff_t>(end),
+                    hit) -
+                _ids.begin());
+        }
+
+        const auto found = kernel().find(
+            {_left.data() + begin,
+             _top.data() + begin,
+             _right.data() + begin,
+             _bottom.data() + begin},
+            end - begin,
+            x,
+            y);
+        if (found >= 0) {
+            hit = _ids[begin + static_cast<std::size_t>(found)];
+        }
+    }
+    return hit;
+}
+
+std::size_t
+hit_index_t::entries() const
+{
+    return _ids.size();
+}
+
+std::string_view
+hit_index_t::isa()
+{
+    return kernel().isa;
+}
+}
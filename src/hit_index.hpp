@@ -0,0 +1,72 @@
+#pragma once
+#ifndef SK_IMPL_HIT_INDEX_HPP
+#define SK_IMPL_HIT_INDEX_HPP
+
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace sk::impl {
+
+/* grids over the rectangles of a scene, each level with cells twice the
+ * size of the one below: a rectangle goes into the finest level whose cells
+ * it spans few of, so it's listed a bounded number of times however large it
+ * is, and large rectangles piled up don't fill the cells of small ones;
+ * every cell lists its rectangles with their edges copied into
+ * flat arrays in element order, so a query is a cell lookup per level
+ * followed by a contiguous scan that tests several boxes per instruction
+ * (avx2 or sse2, picked at run time, with a scalar fallback elsewhere)
+ *
+ * queries return the last element in scene order that contains the point,
+ * i.e. the one drawn on top
+ */
+class hit_index_t {
+public:
+    static constexpr std::uint32_t npos = {UINT32_MAX};
+
+private:
+    struct level_t {
+        int         cell_size  = {1};
+        int         columns    = {0};
+        int         rows       = {0};
+        std::size_t first_cell = {0};
+        std::size_t entries    = {0};
+    };
+
+    int _width  = {0};
+    int _height = {0};
+
+    std::vector<level_t>       _levels; // finest first
+    std::vector<std::uint32_t> _offsets; // per cell, into the arrays below
+
+    // clipped to the window, right and bottom edges are exclusive
+    std::vector<std::int32_t>  _left;
+    std::vector<std::int32_t>  _top;
+    std::vector<std::int32_t>  _right;
+    std::vector<std::int32_t>  _bottom;
+    std::vector<std::uint32_t> _ids;
+
+public:
+    // scene geometry, all spans are of the same size
+    void build(
+        std::span<const int> x,
+        std::span<const int> y,
+        std::span<const int> w,
+        std::span<const int> h,
+        int                  width,
+        int                  height);
+
+    std::uint32_t find(int x, int y) const;
+
+    /* entries over all cells, an element is listed in every cell of its
+     * level it overlaps
+     */
+    std::size_t entries() const;
+
+    // instruction set the box tests are running on
+    static std::string_view isa();
+};
+}
+
+#endif // SK_IMPL_HIT_INDEX_HPP
@@ -0,0 +1,466 @@
+#include "introspection_server.hpp"
+
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "metrics.hpp"
+
+namespace sk::impl {
+
+namespace {
+
+using clock_t = std::chrono::steady_clock;
+
+constexpr std::size_t max_clients = {16};
+constexpr std::size_t max_command = {256}; // longer lines drop the client
+
+/* replies a client doesn't read pile up to this many bytes before it's
+ * dropped; streamed frames stop being queued at a fraction of it
+ */
+constexpr std::size_t max_backlog        = {1024 * 1024};
+constexpr std::size_t max_stream_backlog = {max_backlog / 4};
+
+// frames are taken this often while a client streams them, rarely otherwise
+constexpr int streaming_poll_ms = {10};
+constexpr int idle_poll_ms      = {250};
+
+constexpr auto rate_interval = std::chrono::seconds(1);
+
+struct client_t {
+    int         fd = {-1};
+    std::string input;
+    std::string output;
+    bool        streaming = {false};
+    bool        finished  = {false}; // sending, closed once output is sent
+    bool        closing   = {false};
+};
+
+struct rate_t {
+    std::uint64_t events            = {0};
+    std::uint64_t frames            = {0};
+    double        events_per_second = {0.0};
+    double        frames_per_second = {0.0};
+};
+
+std::system_error
+error(const char* what)
+{
+    return std::system_error(errno, std::generic_category(), what);
+}
+
+/* removes a socket left behind at the address by an application that
+ * crashed; anything else there, a file or the socket of an application
+ * that's still running, is an error
+ */
+void
+remove_stale(const sockaddr_un& address)
+{
+    struct stat status;
+    if (lstat(address.sun_path, &status) < 0) {
+        if (errno == ENOENT) {
+            return;
+        }
+        throw error(address.sun_path);
+    }
+    if (!S_ISSOCK(status.st_mode)) {
+        throw std::runtime_error(
+            std::string(address.sun_path) + ": exists and isn't a socket");
+    }
+
+    const auto probe = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (probe < 0) {
+        throw error(address.sun_path);
+    }
+    const auto connected = connect(
+        probe, reinterpret_cast<const sockaddr*>(&address), sizeof(address));
+    const auto refused = (connected < 0 && errno == ECONNREFUSED);
+    close(probe);
+    if (!refused) {
+        throw std::runtime_error(
+            std::string(address.sun_path) + ": in use by another application");
+    }
+
+    if (unlink(address.sun_path) < 0 && errno != ENOENT) {
+        throw error(address.sun_path);
+    }
+}
+
+std::uint64_t
+rate_key(const metrics_t::window_t& window)
+{
+    return (static_cast<std::uint64_t>(window.generation) << 32u) |
+           window.index;
+}
+
+void
+append_string(std::string& json, std::string_view str)
+{
+    json += '"';
+    for (const auto c : str) {
+        switch (c) {
+        case '"': json += "\\\""; break;
+        case '\\': json += "\\\\"; break;
+        case '\n': json += "\\n"; break;
+        case '\t': json += "\\t"; break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+                char escaped[8];
+                std::snprintf(
+                    escaped, sizeof(escaped), "\\u%04x", static_cast<int>(c));
+                json += escaped;
+            } else {
+                json += c;
+            }
+        }
+    }
+    json += '"';
+}
+
+template <typename ValueType>
+void
+append_field(std::string& json, std::string_view name, ValueType value)
+{
+    if (json.back() != '{') {
+        json += ',';
+    }
+    append_string(json, name);
+    json += ':';
+    if constexpr (std::is_floating_point_v<ValueType>) {
+        char number[32];
+        std::snprintf(number, sizeof(number), "%.1f", value);
+        json += number;
+    } else {
+        json += std::to_string(value);
+    }
+}
+
+void
+append_snapshot(
+    std::string&                                     json,
+    const metrics_t&                                 metrics,
+    const std::unordered_map<std::uint64_t, rate_t>& rates)
+{
+    const auto totals = metrics.totals();
+    json += "{\"totals\":{";
+    append_field(json, "frames", totals.frames);
+    append_field(json, "events", totals.events);
+    append_field(json, "dropped_frames", totals.dropped);
+    append_field(json, "fps", totals.fps);
+    append_field(json, "windows", totals.windows);
+    append_field(json, "timers", totals.timers);
+    append_field(json, "queued_frames", totals.queued);
+    append_field(json, "jobs", totals.jobs);
+    append_field(json, "removed_windows", totals.removed);
+    json += "},\"windows\":[";
+
+    bool first = true;
+    for (const auto& window : metrics.windows()) {
+        json += first ? "{" : ",{";
+        first = false;
+        append_field(json, "index", window.index);
+        append_field(json, "generation", window.generation);
+        json += ",\"title\":";
+        append_string(json, window.title);
+        append_field(json, "x", window.x);
+        append_field(json, "y", window.y);
+        append_field(json, "width", window.width);
+        append_field(json, "height", window.height);
+        append_field(json, "events", window.events);
+        append_field(json, "frames", window.frames);
+
+        // windows younger than the last rate update have none yet
+        const auto found = rates.find(rate_key(window));
+        const auto rate  = (found != rates.end()) ? found->second : rate_t{};
+        append_field(json, "events_per_second", rate.events_per_second);
+        append_field(json, "frames_per_second", rate.frames_per_second);
+        json += '}';
+    }
+    json += "]}\n";
+}
+
+void
+append_frame(std::string& json, const metrics_t::frame_t& frame)
+{
+    json += '{';
+    append_field(json, "frame", frame.number);
+    append_field(json, "started_ns", frame.started_ns);
+    append_field(json, "duration_ns", frame.duration_ns);
+    append_field(json, "events", frame.events);
+    append_field(json, "drawn", frame.drawn);
+    json += "}\n";
+}
+
+// event and frame rates of every window since the previous update
+void
+update_rates(
+    const metrics_t&                           metrics,
+    std::unordered_map<std::uint64_t, rate_t>& rates,
+    double                                     seconds)
+{
+    std::unordered_map<std::uint64_t, rate_t> updated;
+    for (const auto& window : metrics.windows()) {
+        rate_t     rate     = {window.events, window.frames, 0.0, 0.0};
+        const auto previous = rates.find(rate_key(window));
+        if (previous != rates.end()) {
+            rate.events_per_second =
+                static_cast<double>(window.events - previous->second.events) /
+                seconds;
+            rate.frames_per_second =
+                static_cast<double>(window.frames - previous->second.frames) /
+                seconds;
+        }
+        updated.emplace(rate_key(window), rate);
+    }
+    rates = std::move(updated);
+}
+
+void
+handle_command(
+    client_t&                                        client,
+    std::string_view                                 command,
+    const metrics_t&                                 metrics,
+    const std::unordered_map<std::uint64_t, rate_t>& rates)
+{
+    if (!command.empty() && command.back() == '\r') {
+        command.remove_suffix(1);
+    }
+
+    if (command == "snapshot") {
+        append_snapshot(client.output, metrics, rates);
+    } else if (command == "stream") {
+        client.streaming = true;
+    } else if (command == "stop") {
+        client.streaming = false;
+    } else if (!command.empty()) {
+        client.output += "{\"error\":\"unknown command\"}\n";
+    }
+}
+
+void
+receive(
+    client_t&                                        client,
+    const metrics_t&                                 metrics,
+    const std::unordered_map<std::uint64_t, rate_t>& rates)
+{
+    char buffer[512];
+    while (true) {
+        const auto received = recv(client.fd, buffer, sizeof(buffer), 0);
+        if (received == 0) {
+            // commands sent before are still answered
+            client.finished = true;
+            break;
+        }
+        if (received < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            client.closing = (errno != EAGAIN && errno != EWOULDBLOCK);
+            break;
+        }
+        client.input.append(buffer, static_cast<std::size_t>(received));
+    }
+
+    std::size_t start = 0;
+    for (auto end = client.input.find('\n'); end != std::string::npos;
+         end      = client.input.find('\n', start)) {
+        handle_command(
+            client,
+            std::string_view(client.input).substr(start, end - start),
+            metrics,
+            rates);
+        start = end + 1;
+    }
+    client.input.erase(0, start);
+    if (client.finished && !client.input.empty()) {
+        handle_command(client, client.input, metrics, rates);
+        client.input.clear();
+    }
+    if (client.input.size() > max_command) {
+        client.closing = true;
+    }
+}
+
+void
+send_output(client_t& client)
+{
+    while (!client.output.empty()) {
+        const auto sent = send(
+            client.fd,
+            client.output.data(),
+            client.output.size(),
+            MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            client.closing = (errno != EAGAIN && errno != EWOULDBLOCK);
+            break;
+        }
+        client.output.erase(0, static_cast<std::size_t>(sent));
+    }
+
+    if (client.output.size() > max_backlog ||
+        (client.finished && client.output.empty())) {
+        client.closing = true;
+    }
+}
+}
+
+introspection_server_t::introspection_server_t(
+    std::string_view path, metrics_t& metrics)
+    : _metrics(metrics), _path(path)
+{
+    sockaddr_un address = {};
+    address.sun_family  = AF_UNIX;
+    if (_path.empty() || _path.size() >= sizeof(address.sun_path)) {
+        throw std::invalid_argument(
+            "introspection socket path is empty or too long");
+    }
+    std::memcpy(address.sun_path, _path.c_str(), _path.size() + 1);
+
+    remove_stale(address);
+
+    _listener = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (_listener < 0) {
+        throw error(_path.c_str());
+    }
+
+    // the socket is only removed once it's ours
+    if (bind(_listener,
+             reinterpret_cast<const sockaddr*>(&address),
+             sizeof(address)) < 0) {
+        const auto failed = error(_path.c_str());
+        close(_listener);
+        throw failed;
+    }
+    if (listen(_listener, static_cast<int>(max_clients)) < 0 ||
+        pipe2(_wake, O_CLOEXEC) < 0) {
+        const auto failed = error(_path.c_str());
+        close(_listener);
+        unlink(_path.c_str());
+        throw failed;
+    }
+
+    _thread = std::thread([this] { serve(); });
+}
+
+introspection_server_t::~introspection_server_t()
+{
+    close(_wake[1]);
+    _thread.join();
+    close(_wake[0]);
+    close(_listener);
+    unlink(_path.c_str());
+}
+
+void
+introspection_server_t::serve()
+{
+    std::vector<client_t>                     clients;
+    std::vector<pollfd>                       fds;
+    std::unordered_map<std::uint64_t, rate_t> rates;
+    std::string                               frames;
+
+    // the first pass only takes the counts rates are computed from
+    auto rated = clock_t::now() - rate_interval;
+
+    while (true) {
+        bool streaming = false;
+        fds.clear();
+        fds.push_back({_wake[0], POLLIN, 0});
+        fds.push_back({_listener, POLLIN, 0});
+        for (const auto& client : clients) {
+            const auto events = static_cast<short>(
+                (client.finished ? 0 : POLLIN) |
+                (client.output.empty() ? 0 : POLLOUT));
+            fds.push_back({client.fd, events, 0});
+            streaming = streaming || client.streaming;
+        }
+
+        const auto ready = poll(
+            fds.data(),
+            fds.size(),
+            streaming ? streaming_poll_ms : idle_poll_ms);
+        if (ready < 0 && errno != EINTR) {
+            break;
+        }
+        if (fds[0].revents) {
+            break; // the write end was closed
+        }
+
+        const auto now = clock_t::now();
+        if (now - rated >= rate_interval) {
+            update_rates(
+                _metrics,
+                rates,
+                std::chrono::duration<double>(now - rated).count());
+            rated = now;
+        }
+
+        for (std::size_t i = 0; i < clients.size(); ++i) {
+            if (fds[i + 2].revents & (POLLIN | POLLHUP | POLLERR)) {
+                receive(clients[i], _metrics, rates);
+            }
+        }
+
+        // the ring is drained either way, so that its frames stay current
+        frames.clear();
+        _metrics.take_frames(
+            [&frames](const auto& frame) { append_frame(frames, frame); });
+        for (auto& client : clients) {
+            if (client.streaming &&
+                client.output.size() + frames.size() <= max_stream_backlog) {
+                client.output += frames;
+            }
+            if (!client.closing) {
+                send_output(client);
+            }
+        }
+
+        // closed clients are swapped out before new ones come in
+        for (std::size_t i = 0; i < clients.size();) {
+            if (clients[i].closing) {
+                close(clients[i].fd);
+                clients[i] = std::move(clients.back());
+                clients.pop_back();
+            } else {
+                ++i;
+            }
+        }
+
+        if (fds[1].revents & POLLIN) {
+            int fd;
+            while ((fd = accept4(
+                        _listener,
+                        nullptr,
+                        nullptr,
+                        SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0) {
+                if (clients.size() < max_clients) {
+                    clients.push_back({fd, {}, {}, false, false, false});
+                } else {
+                    close(fd);
+                }
+            }
+        }
+    }
+
+    for (const auto& client : clients) {
+        close(client.fd);
+    }
+}
+}
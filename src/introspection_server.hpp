@@ -0,0 +1,46 @@
+#pragma once
+#ifndef SK_IMPL_INTROSPECTION_SERVER_HPP
+#define SK_IMPL_INTROSPECTION_SERVER_HPP
+
+#include <string>
+#include <string_view>
+#include <thread>
+
+namespace sk::impl {
+
+class metrics_t;
+
+/* serves metrics on a unix domain socket from a thread of its own, which
+ * only ever reads them, so clients can't stall the application loop
+ *
+ * the protocol is line based, one command per line and one JSON object per
+ * line in reply:
+ *   snapshot  totals, queue depths and every window with its geometry and
+ *             event and frame rates over the last second
+ *   stream    then one object per frame of the application loop, until the
+ *             client sends stop or goes away
+ * clients that don't keep up with a stream miss frames, those that stop
+ * reading altogether are disconnected
+ */
+class introspection_server_t final {
+    metrics_t&  _metrics;
+    std::string _path;
+    int         _listener = {-1};
+    int         _wake[2]  = {-1, -1}; // pipe, closing it stops the thread
+    std::thread _thread;
+
+    void serve();
+
+public:
+    /* a stale socket at path, one nobody listens on, is replaced, anything
+     * else there throws; the socket is removed on destruction
+     */
+    introspection_server_t(std::string_view path, metrics_t& metrics);
+    ~introspection_server_t();
+
+    introspection_server_t(const introspection_server_t&) = delete;
+    introspection_server_t& operator=(const introspection_server_t&) = delete;
+};
+}
+
+#endif // SK_IMPL_INTROSPECTION_SERVER_HPP
@@ -0,0 +1,172 @@
+#include "job_system.hpp"
+
+#include <algorithm>
+#include <exception>
+
+namespace sk::impl {
+
+namespace {
+
+// the worker the calling thread is, and of which job system
+struct worker_t {
+    const job_system_t* owner = {nullptr};
+    std::size_t         index = {0};
+};
+
+thread_local worker_t this_worker;
+}
+
+job_system_t::job_system_t(std::size_t workers)
+{
+    // the main thread keeps a core for itself
+    workers = std::max<std::size_t>(workers, 2) - 1;
+    for (std::size_t i = 0; i < workers; ++i) {
+        _queues.emplace_back(std::make_unique<queue_t>());
+    }
+
+    for (std::size_t i = 0; i < workers; ++i) {
+        _workers.emplace_back([this, i] { work(i); });
+    }
+}
+
+job_system_t::~job_system_t()
+{
+    {
+        // under the lock, so no worker is between checking and sleeping
+        std::lock_guard lock(_sleep_mutex);
+        _stopping = true;
+    }
+    _sleep.notify_all();
+
+    for (auto& worker : _workers) {
+        worker.join();
+    }
+}
+
+void
+job_system_t::submit(job_t&& job)
+{
+    const auto queue = (this_worker.owner == this)
+                           ? this_worker.index
+                           : _next_queue++ % _queues.size();
+
+    /* counted before it's published, a worker taking it right away would
+     * otherwise uncount it first
+     */
+    ++_pending;
+    {
+        std::lock_guard lock(_queues[queue]->mutex);
+        _queues[queue]->jobs.push_back(std::move(job));
+    }
+
+    /* a worker going to sleep counts itself before it checks for jobs, and
+     * the job was counted before the sleepers are, so either it sees the job
+     * or it's seen here and woken; the lock keeps the wakeup from falling
+     * between its check and its wait
+     */
+    if (_sleeping) {
+        std::lock_guard lock(_sleep_mutex);
+        _sleep.notify_one();
+    }
+}
+
+bool
+job_system_t::take(std::size_t worker, job_t& job)
+{
+    {
+        auto&           own = *_queues[worker];
+        std::lock_guard lock(own.mutex);
+        if (!own.jobs.empty()) {
+            job = std::move(own.jobs.back());
+            own.jobs.pop_back();
+            return true;
+        }
+    }
+
+    for (std::size_t i = 1; i < _queues.size(); ++i) {
+        auto&           victim = *_queues[(worker + i) % _queues.size()];
+        std::lock_guard lock(victim.mutex);
+        if (!victim.jobs.empty()) {
+            job = std::move(victim.jobs.front());
+            victim.jobs.pop_front();
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void
+job_system_t::work(std::size_t worker)
+{
+    this_worker = {this, worker};
+
+    job_t job;
+    while (!_stopping) {
+        if (!take(worker, job)) {
+            if (_pending) {
+                // being pushed, or somebody else was faster
+                std::this_thread::yield();
+                continue;
+            }
+
+            std::unique_lock lock(_sleep_mutex);
+            ++_sleeping;
+            _sleep.wait(lock, [this] { return _pending || _stopping; });
+            --_sleeping;
+            continue;
+        }
+
+        --_pending;
+
+        try {
+            job();
+        } catch (...) {
+            // rethrown from the main loop, out of application_t::run
+            post([error = std::current_exception()] {
+                std::rethrow_exception(error);
+            });
+        }
+        job = nullptr;
+    }
+}
+
+void
+job_system_t::post(job_t&& continuation)
+{
+    {
+        std::lock_guard lock(_done_mutex);
+        _done.push_back(std::move(continuation));
+    }
+    _done_signal.notify_one();
+}
+
+std::size_t
+job_system_t::drain()
+{
+    std::vector<job_t> done;
+    {
+        std::lock_guard lock(_done_mutex);
+        done.swap(_done);
+    }
+
+    for (auto& continuation : done) {
+        continuation();
+    }
+
+    return done.size();
+}
+
+std::size_t
+job_system_t::pending() const
+{
+    return _pending;
+}
+
+void
+job_system_t::wait_until(std::chrono::steady_clock::time_point deadline)
+{
+    std::unique_lock lock(_done_mutex);
+    _done_signal.wait_until(lock, deadline, [this] { return !_done.empty(); });
+}
+}
@@ -0,0 +1,80 @@
+#pragma once
+#ifndef SK_IMPL_JOB_SYSTEM_HPP
+#define SK_IMPL_JOB_SYSTEM_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace sk::impl {
+
+/* pool of worker threads, one per spare core, each with its own deque:
+ * a worker takes its newest job first and steals the oldest ones from the
+ * others when it runs dry; continuations are handed back to the main loop
+ * through post() and run there by drain()
+ */
+class job_system_t {
+public:
+    using job_t = std::function<void()>;
+
+private:
+    struct queue_t {
+        std::mutex         mutex;
+        std::deque<job_t> jobs;
+    };
+
+    std::vector<std::unique_ptr<queue_t>> _queues;
+    std::vector<std::thread>              _workers;
+    std::atomic<std::size_t>              _next_queue = {0};
+
+    /* jobs are counted before they're pushed and uncounted once taken;
+     * submit only takes the mutex to wake a worker when one may be asleep,
+     * and workers only take it to fall asleep
+     */
+    std::atomic<std::size_t> _pending  = {0};
+    std::atomic<std::size_t> _sleeping = {0};
+    std::atomic<bool>        _stopping = {false};
+    std::mutex               _sleep_mutex;
+    std::condition_variable  _sleep;
+
+    std::mutex              _done_mutex;
+    std::condition_variable _done_signal;
+    std::vector<job_t>      _done;
+
+    bool take(std::size_t worker, job_t& job);
+    void work(std::size_t worker);
+
+public:
+    job_system_t& operator=(const job_system_t&) = delete;
+    job_system_t& operator=(job_system_t&&) = delete;
+    job_system_t(const job_system_t&)       = delete;
+    job_system_t(job_system_t&&)            = delete;
+
+    explicit job_system_t(
+        std::size_t workers = std::thread::hardware_concurrency());
+    ~job_system_t();
+
+    // callable from any thread, jobs spawned by a job stay on its worker
+    void submit(job_t&&);
+
+    // hands a continuation over to the main loop, callable from any thread
+    void post(job_t&&);
+
+    // runs posted continuations, main thread only
+    std::size_t drain();
+
+    // jobs submitted but not taken by a worker yet
+    std::size_t pending() const;
+
+    // sleeps until the deadline or until a continuation is posted
+    void wait_until(std::chrono::steady_clock::time_point deadline);
+};
+}
+
+#endif // SK_IMPL_JOB_SYSTEM_HPP
@@ -0,0 +1,177 @@
+#include <sketch/keyboard.hpp>
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "chord_table.hpp"
+
+namespace sk {
+
+namespace {
+
+constexpr auto all_modifiers = modifiers_t::shift | modifiers_t::ctrl |
+                               modifiers_t::alt | modifiers_t::gui;
+
+std::uint64_t
+bit(scancode_t scancode)
+{
+    return std::uint64_t{1} << (scancode % 64u);
+}
+
+binding_id_t
+make_id(std::uint32_t slot, std::uint32_t generation)
+{
+    return (static_cast<binding_id_t>(generation) << 32u) | slot;
+}
+}
+
+keyboard_t::keyboard_t() = default;
+
+keyboard_t::~keyboard_t() = default;
+
+keyboard_t::keyboard_t(keyboard_t&&) noexcept = default;
+
+keyboard_t&
+keyboard_t::operator=(keyboard_t&&) noexcept = default;
+
+bool
+keyboard_t::is_down(scancode_t scancode) const
+{
+    return scancode < scancodes && (_down[scancode / 64u] & bit(scancode));
+}
+
+modifiers_t
+keyboard_t::modifiers() const
+{
+    return _modifiers;
+}
+
+binding_id_t
+keyboard_t::add(const chord_t& chord, handler_t&& handler)
+{
+    if (chord.scancode >= scancodes ||
+        (chord.modifiers & all_modifiers) != chord.modifiers) {
+        throw std::invalid_argument("no such chord");
+    }
+
+    std::uint32_t slot = 0;
+    if (_free.empty()) {
+        slot = static_cast<std::uint32_t>(_bindings.size());
+        _bindings.emplace_back();
+    } else {
+        slot = _free.back();
+        _free.pop_back();
+    }
+
+    auto& binding   = _bindings[slot];
+    binding.chord   = chord;
+    binding.handler = std::move(handler);
+    binding.order   = _order++;
+    binding.bound   = true;
+    ++_bound;
+    _compiled = false;
+    return make_id(slot, binding.generation);
+}
+
+bool
+keyboard_t::unbind(binding_id_t id)
+{
+    const auto slot       = static_cast<std::uint32_t>(id & UINT32_MAX);
+    const auto generation = static_cast<std::uint32_t>(id >> 32u);
+    if (slot >= _bindings.size() || !_bindings[slot].bound ||
+        _bindings[slot].generation != generation) {
+        return false;
+    }
+
+    // the handler may be the one running, it's released by compile
+    _bindings[slot].bound = false;
+    _unbound.push_back(slot);
+    --_bound;
+    _compiled = false;
+    return true;
+}
+
+std::size_t
+keyboard_t::bindings() const
+{
+    return _bound;
+}
+
+void
+keyboard_t::compile()
+{
+    for (const auto slot : _unbound) {
+        auto& binding   = _bindings[slot];
+        binding.handler = nullptr;
+        ++binding.generation;
+        _free.push_back(slot);
+    }
+    _unbound.clear();
+
+    std::vector<impl::chord_table_t::entry_t> entries;
+    entries.reserve(_bound);
+    for (std::size_t slot = 0; slot < _bindings.size(); ++slot) {
+        if (_bindings[slot].bound) {
+            entries.push_back(
+                {_bindings[slot].chord, static_cast<std::uint32_t>(slot)});
+        }
+    }
+    std::sort(
+        entries.begin(), entries.end(), [this](const auto& a, const auto& b) {
+            return _bindings[a.slot].order < _bindings[b.slot].order;
+        });
+
+    if (!_table) {
+        _table = std::make_unique<impl::chord_table_t>();
+    }
+    _table->build(entries);
+    _compiled = true;
+}
+
+void
+keyboard_t::update(const key_event_t& event)
+{
+    _modifiers = event.modifiers & all_modifiers;
+    if (event.scancode >= scancodes) {
+        return;
+    }
+
+    auto& word = _down[event.scancode / 64u];
+    word       = event.pressed ? (word | bit(event.scancode))
+                               : (word & ~bit(event.scancode));
+}
+
+std::size_t
+keyboard_t::dispatch(const key_event_t& event)
+{
+    if (!event.pressed || event.repeat || event.scancode >= scancodes) {
+        return 0;
+    }
+
+    if (!_compiled) {
+        compile();
+    }
+    if (!_table) {
+        return 0;
+    }
+
+    // handlers may bind and unbind, neither touches the table until the
+    // next press
+    std::size_t ran = 0;
+    const chord_t chord = {event.modifiers & all_modifiers, event.scancode};
+    for (const auto slot : _table->find(chord)) {
+        if (_bindings[slot].bound) {
+            _bindings[slot].handler(_window);
+            ++ran;
+        }
+    }
+    return ran;
+}
+
+void
+keyboard_t::release_all()
+{
+    _down.fill(0);
+    _modifiers = modifiers_t::none;
+}
+}
@@ -0,0 +1,171 @@
+#include "layout_engine.hpp"
+
+#include <algorithm>
+
+namespace sk::impl {
+
+namespace {
+
+// the fraction, capped at the parent, and then its offset
+int
+resolve_fraction(const length_t& length, int parent)
+{
+    return std::min(
+               static_cast<int>(length.value * static_cast<double>(parent)),
+               parent) +
+           static_cast<int>(length.offset);
+}
+
+int
+resolve_extent(const length_t& length, int parent)
+{
+    switch (length.unit) {
+    case length_t::unit_t::pixels:
+        return std::max(static_cast<int>(length.value), 0);
+    case length_t::unit_t::fraction:
+        return std::max(resolve_fraction(length, parent), 0);
+    default: return parent;
+    }
+}
+
+int
+resolve_offset(const length_t& length, int origin, int parent, int extent)
+{
+    switch (length.unit) {
+    case length_t::unit_t::pixels:
+        return origin + static_cast<int>(length.value);
+    case length_t::unit_t::fraction:
+        return origin + resolve_fraction(length, parent);
+    case length_t::unit_t::full: return origin;
+    case length_t::unit_t::centered: return origin + (parent - extent) / 2;
+    default: return layout_engine_t::unset;
+    }
+}
+}
+
+layout_engine_t::rect_t
+layout_engine_t::resolve(const geometry_t& geometry, const rect_t& parent)
+{
+    rect_t result;
+    result.w = resolve_extent(geometry.width, parent.w);
+    result.h = resolve_extent(geometry.height, parent.h);
+    result.x = resolve_offset(geometry.x, parent.x, parent.w, result.w);
+    result.y = resolve_offset(geometry.y, parent.y, parent.h, result.h);
+    return result;
+}
+
+void
+layout_engine_t::parent_bounds(std::size_t parent, const rect_t& bounds)
+{
+    if (parent >= _parents.size()) {
+        _parents.resize(parent + 1);
+    }
+
+    auto& entry = _parents[parent];
+    if (entry.bounds == bounds) {
+        return;
+    }
+
+    entry.bounds = bounds;
+    for (const auto slot : entry.children) {
+        queue(slot);
+    }
+}
+
+std::size_t
+layout_engine_t::parents() const
+{
+    return _parents.size();
+}
+
+void
+layout_engine_t::attach(std::uint32_t slot, const geometry_t& geometry)
+{
+    if (slot >= _parent.size()) {
+        const auto size = static_cast<std::size_t>(slot) + 1;
+        _geometry.resize(size);
+        _resolved.resize(size);
+        _parent.resize(size, npos);
+        _child_index.resize(size, npos);
+        _queued.resize(size, false);
+    }
+
+    unlink(slot);
+    _geometry[slot] = geometry;
+    link(slot, static_cast<std::uint32_t>(std::max(geometry.display, 0)));
+    _resolved[slot] = resolve(geometry, _parents[_parent[slot]].bounds);
+}
+
+void
+layout_engine_t::detach(std::uint32_t slot)
+{
+    if (slot < _parent.size()) {
+        unlink(slot);
+    }
+}
+
+void
+layout_engine_t::constrain(std::uint32_t slot, const geometry_t& geometry)
+{
+    if (slot >= _parent.size() || _parent[slot] == npos) {
+        return;
+    }
+
+    const auto parent =
+        static_cast<std::uint32_t>(std::max(geometry.display, 0));
+    if (parent != _parent[slot]) {
+        unlink(slot);
+        link(slot, parent);
+    }
+
+    _geometry[slot] = geometry;
+    queue(slot);
+}
+
+std::size_t
+layout_engine_t::pending() const
+{
+    return _dirty.size();
+}
+
+void
+layout_engine_t::queue(std::uint32_t slot)
+{
+    if (!_queued[slot]) {
+        _queued[slot] = true;
+        _dirty.push_back(slot);
+    }
+}
+
+void
+layout_engine_t::unlink(std::uint32_t slot)
+{
+    const auto parent = _parent[slot];
+    if (parent == npos) {
+        return;
+    }
+
+    // swap the last child into the vacated position
+    auto&      children = _parents[parent].children;
+    const auto index    = _child_index[slot];
+    children[index]     = children.back();
+    _child_index[children[index]] = index;
+    children.pop_back();
+
+    _parent[slot]      = npos;
+    _child_index[slot] = npos;
+}
+
+void
+layout_engine_t::link(std::uint32_t slot, std::uint32_t parent)
+{
+    if (parent >= _parents.size()) {
+        _parents.resize(parent + 1);
+    }
+
+    auto& children     = _parents[parent].children;
+    _parent[slot]      = parent;
+    _child_index[slot] = static_cast<std::uint32_t>(children.size());
+    children.push_back(slot);
+}
+}
@@ -0,0 +1,102 @@
+#pragma once
+#ifndef SK_IMPL_LAYOUT_ENGINE_HPP
+#define SK_IMPL_LAYOUT_ENGINE_HPP
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include <sketch/geometry.hpp>
+
+namespace sk::impl {
+
+/* keeps the constraints of every window next to the bounds of its parent
+ * (its display) and resolves them to pixels; a change of constraints or of
+ * parent bounds only queues the affected windows, which are then recomputed
+ * in a single pass by update(), once per frame
+ *
+ * windows are keyed by their registry slot, constraints and results are kept
+ * in flat per-slot arrays so the pass touches as little memory as possible
+ */
+class layout_engine_t {
+public:
+    // positions that are left to the system
+    static constexpr int unset = {std::numeric_limits<int>::min()};
+
+    struct rect_t {
+        int x = {0};
+        int y = {0};
+        int w = {0};
+        int h = {0};
+
+        bool operator==(const rect_t&) const = default;
+    };
+
+    static rect_t resolve(const geometry_t&, const rect_t& parent);
+
+private:
+    static constexpr std::uint32_t npos = {UINT32_MAX};
+
+    struct parent_t {
+        rect_t                     bounds;
+        std::vector<std::uint32_t> children; // slots
+    };
+
+    std::vector<parent_t> _parents;
+
+    // per slot, the parent is npos for slots without a window
+    std::vector<geometry_t>    _geometry;
+    std::vector<rect_t>        _resolved;
+    std::vector<std::uint32_t> _parent;
+    std::vector<std::uint32_t> _child_index; // within the parent's children
+    std::vector<bool>          _queued;
+
+    std::vector<std::uint32_t> _dirty;
+
+    void queue(std::uint32_t slot);
+    void unlink(std::uint32_t slot);
+    void link(std::uint32_t slot, std::uint32_t parent);
+
+public:
+    // parents are numbered from zero, unknown ones are empty rectangles
+    void        parent_bounds(std::size_t parent, const rect_t&);
+    std::size_t parents() const;
+
+    // the window is assumed to be laid out against the current bounds already
+    void attach(std::uint32_t slot, const geometry_t&);
+    void detach(std::uint32_t slot);
+    void constrain(std::uint32_t slot, const geometry_t&);
+
+    std::size_t pending() const;
+
+    /* recomputes queued windows, apply is called as apply(slot, rect) for
+     * every window whose resolved geometry actually changed; returns the
+     * number of such windows
+     */
+    template <typename FuncType>
+    std::size_t
+    update(FuncType&& apply)
+    {
+        std::size_t changed = 0;
+        for (const auto slot : _dirty) {
+            _queued[slot] = false;
+            if (_parent[slot] == npos) {
+                continue;
+            }
+
+            const auto rect =
+                resolve(_geometry[slot], _parents[_parent[slot]].bounds);
+            if (rect != _resolved[slot]) {
+                _resolved[slot] = rect;
+                apply(slot, rect);
+                ++changed;
+            }
+        }
+
+        _dirty.clear();
+        return changed;
+    }
+};
+}
+
+#endif // SK_IMPL_LAYOUT_ENGINE_HPP
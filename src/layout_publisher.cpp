@@ -0,0 +1,28 @@
+#include <sketch/layout_publisher.hpp>
+
+#include <iostream>
+
+#include "layout_segment.hpp"
+
+namespace sk {
+
+layout_publisher_t::layout_publisher_t(std::string_view segment)
+    : _segment(std::make_unique<impl::layout_segment_t>(
+          segment, impl::layout_segment_t::access_t::publish))
+{
+}
+
+layout_publisher_t::~layout_publisher_t() = default;
+
+std::uint64_t
+layout_publisher_t::publish(const std::vector<std::string>& filenames)
+{
+    return _segment->publish(impl::load_window_specs(filenames, std::cerr));
+}
+
+std::uint64_t
+layout_publisher_t::generation() const
+{
+    return _segment->generation();
+}
+}
@@ -0,0 +1,390 @@
+#include "layout_segment.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace sk::impl {
+
+namespace {
+
+constexpr char         magic[4] = {'S', 'K', 'L', 'S'};
+constexpr std::uint8_t version  = {1};
+
+// of a new segment, it doubles whenever the tables outgrow it
+constexpr std::size_t initial_size = {64 * 1024};
+
+// reads overlapping with publishes are retried this many times
+constexpr std::size_t read_attempts = {64};
+
+static_assert(std::is_trivially_copyable_v<geometry_t>);
+
+// offsets and sizes are of the characters that follow the tables
+struct window_record_t {
+    geometry_t    geometry;
+    std::uint32_t title;
+    std::uint32_t title_size;
+    std::uint32_t first; // element
+    std::uint32_t elements;
+};
+
+struct element_record_t {
+    geometry_t     geometry;
+    element_id_t   parent;
+    std::uint32_t  text;
+    std::uint32_t  text_size;
+    element_kind_t kind;
+};
+
+// processes built from other sources lay records out differently
+constexpr std::uint32_t record_layout = {
+    (sizeof(window_record_t) << 16) | sizeof(element_record_t)};
+
+std::system_error
+error(const char* what)
+{
+    return std::system_error(errno, std::generic_category(), what);
+}
+
+std::string
+shm_name(std::string_view name)
+{
+    return (name.substr(0, 1) == "/") ? std::string(name)
+                                      : "/" + std::string(name);
+}
+
+std::uint32_t
+narrow(std::size_t value)
+{
+    if (value > UINT32_MAX) {
+        throw std::length_error("layout too large to publish");
+    }
+    return static_cast<std::uint32_t>(value);
+}
+
+template <typename RecordType>
+void
+put(std::byte* table, std::size_t index, const RecordType& record)
+{
+    std::memcpy(table + index * sizeof(RecordType), &record, sizeof(record));
+}
+
+template <typename RecordType>
+RecordType
+get(const std::byte* table, std::size_t index)
+{
+    RecordType result;
+    std::memcpy(&result, table + index * sizeof(RecordType), sizeof(result));
+    return result;
+}
+}
+
+/* everything but the sequence is written only while it's odd; the counts are
+ * atomics nonetheless, as readers may load them while they're written
+ */
+struct layout_segment_t::header_t {
+    char                       magic[4];
+    std::uint8_t               version;
+    std::uint32_t              layout;
+    std::atomic<std::uint64_t> sequence;
+    std::atomic<std::uint64_t> size; // of the segment, it never shrinks
+    std::atomic<std::uint32_t> windows;
+    std::atomic<std::uint32_t> elements;
+    std::atomic<std::uint32_t> characters;
+
+    static_assert(std::atomic<std::uint64_t>::is_always_lock_free);
+};
+
+layout_follower_t::layout_follower_t(std::string_view name)
+    : segment(name, layout_segment_t::access_t::follow)
+{
+}
+
+layout_segment_t::layout_segment_t(std::string_view name, access_t access)
+    : _name(shm_name(name)), _access(access)
+{
+    const auto publishing = (access == access_t::publish);
+    _fd                   = shm_open(
+        _name.c_str(), publishing ? (O_RDWR | O_CREAT) : O_RDONLY, 0644);
+    if (_fd < 0) {
+        throw error(_name.c_str());
+    }
+
+    struct stat status;
+    if (fstat(_fd, &status) < 0) {
+        const auto failed = error(_name.c_str());
+        close(_fd);
+        throw failed;
+    }
+
+    auto size = static_cast<std::size_t>(status.st_size);
+    if (publishing && size < initial_size) {
+        size = initial_size;
+        if (ftruncate(_fd, static_cast<off_t>(size)) < 0) {
+            const auto failed = error(_name.c_str());
+            close(_fd);
+            throw failed;
+        }
+    }
+
+    if (size < sizeof(header_t)) {
+        close(_fd);
+        throw std::runtime_error(_name + " is not a layout segment");
+    }
+
+    try {
+        map(size);
+    } catch (...) {
+        close(_fd);
+        throw;
+    }
+
+    // a segment left behind by an earlier publisher keeps its sequence, so
+    // that whoever still maps it sees the change
+    auto&      head  = header();
+    const auto valid = std::equal(magic, magic + 4, head.magic) &&
+                       head.version == version && head.layout == record_layout;
+    if (publishing && !valid) {
+        std::copy(magic, magic + 4, head.magic);
+        head.version = version;
+        head.layout  = record_layout;
+        head.sequence.store(0, std::memory_order_relaxed);
+        head.windows.store(0, std::memory_order_relaxed);
+        head.elements.store(0, std::memory_order_relaxed);
+        head.characters.store(0, std::memory_order_relaxed);
+    }
+    if (publishing) {
+        head.size.store(size, std::memory_order_release);
+    } else if (!valid) {
+        munmap(_data, _size);
+        close(_fd);
+        throw std::runtime_error(
+            _name + " is not a layout segment of this version");
+    }
+}
+
+layout_segment_t::~layout_segment_t()
+{
+    munmap(_data, _size);
+    close(_fd);
+    if (_access == access_t::publish) {
+        shm_unlink(_name.c_str());
+    }
+}
+
+layout_segment_t::header_t&
+layout_segment_t::header()
+{
+    return *static_cast<header_t*>(_data);
+}
+
+const layout_segment_t::header_t&
+layout_segment_t::header() const
+{
+    return *static_cast<const header_t*>(_data);
+}
+
+void
+layout_segment_t::map(std::size_t size)
+{
+    const auto protection =
+        (_access == access_t::publish) ? (PROT_READ | PROT_WRITE) : PROT_READ;
+    auto* data = mmap(nullptr, size, protection, MAP_SHARED, _fd, 0);
+    if (data == MAP_FAILED) {
+        throw error(_name.c_str());
+    }
+
+    if (_data) {
+        munmap(_data, _size);
+    }
+    _data = data;
+    _size = size;
+}
+
+std::uint64_t
+layout_segment_t::publish(const std::vector<window_spec_t>& specs)
+{
+    // the tables are put together first, readers only wait for the copy
+    std::size_t elements   = 0;
+    std::size_t characters = 0;
+    for (const auto& spec : specs) {
+        elements += spec.elements.size();
+        characters += spec.title.size();
+        for (const auto& element : spec.elements) {
+            characters += element.text.size();
+        }
+    }
+
+    const auto windows_bytes  = specs.size() * sizeof(window_record_t);
+    const auto elements_bytes = elements * sizeof(element_record_t);
+    std::vector<std::byte> tables(windows_bytes + elements_bytes + characters);
+
+    auto*       text  = tables.data() + windows_bytes + elements_bytes;
+    std::size_t at    = 0;
+    std::size_t first = 0;
+    const auto  store = [&](const std::string& str) {
+        std::memcpy(text + at, str.data(), str.size());
+        at += str.size();
+        return narrow(at - str.size());
+    };
+
+    for (std::size_t i = 0; i < specs.size(); ++i) {
+        const auto& spec = specs[i];
+        put(tables.data(),
+            i,
+            window_record_t{spec.geometry,
+                            store(spec.title),
+                            narrow(spec.title.size()),
+                            narrow(first),
+                            narrow(spec.elements.size())});
+        for (const auto& element : spec.elements) {
+            put(tables.data() + windows_bytes,
+                first++,
+                element_record_t{element.geometry,
+                                 element.parent,
+                                 store(element.text),
+                                 narrow(element.text.size()),
+                                 element.kind});
+        }
+    }
+
+    // growing only adds to the end, readers map it again once they see it
+    const auto needed = sizeof(header_t) + tables.size();
+    if (needed > _size) {
+        auto size = _size;
+        while (size < needed) {
+            size *= 2;
+        }
+        if (ftruncate(_fd, static_cast<off_t>(size)) < 0) {
+            throw error(_name.c_str());
+        }
+        map(size);
+        header().size.store(size, std::memory_order_release);
+    }
+
+    auto&      head     = header();
+    const auto sequence = head.sequence.load(std::memory_order_relaxed) | 1;
+    head.sequence.store(sequence, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    head.windows.store(narrow(specs.size()), std::memory_order_relaxed);
+    head.elements.store(narrow(elements), std::memory_order_relaxed);
+    head.characters.store(narrow(characters), std::memory_order_relaxed);
+    std::memcpy(
+        static_cast<std::byte*>(_data) + sizeof(header_t),
+        tables.data(),
+        tables.size());
+
+    head.sequence.store(sequence + 1, std::memory_order_release);
+    return (sequence + 1) / 2;
+}
+
+std::uint64_t
+layout_segment_t::generation() const
+{
+    return header().sequence.load(std::memory_order_acquire) / 2;
+}
+
+std::optional<std::pair<std::vector<window_spec_t>, std::uint64_t>>
+layout_segment_t::read()
+{
+    std::size_t   windows    = 0;
+    std::size_t   elements   = 0;
+    std::size_t   characters = 0;
+    std::uint64_t sequence   = 0;
+    bool          copied     = false;
+    for (std::size_t attempt = 0; !copied && attempt < read_attempts;
+         ++attempt) {
+        if (attempt) {
+            std::this_thread::yield();
+        }
+
+        const auto& head = header();
+        sequence         = head.sequence.load(std::memory_order_acquire);
+        if (sequence & 1) {
+            continue;
+        }
+
+        const auto size = head.size.load(std::memory_order_acquire);
+        if (size > _size) {
+            map(size);
+            continue;
+        }
+
+        windows    = head.windows.load(std::memory_order_relaxed);
+        elements   = head.elements.load(std::memory_order_relaxed);
+        characters = head.characters.load(std::memory_order_relaxed);
+
+        // counts torn by a publish may add up to anything
+        const auto bytes = windows * sizeof(window_record_t) +
+                           elements * sizeof(element_record_t) + characters;
+        if (bytes && bytes <= _size - sizeof(header_t)) {
+            _copy.resize(bytes);
+            std::memcpy(
+                _copy.data(),
+                static_cast<const std::byte*>(_data) + sizeof(header_t),
+                bytes);
+        }
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        copied = (head.sequence.load(std::memory_order_relaxed) == sequence) &&
+                 (bytes <= _size - sizeof(header_t));
+    }
+
+    if (!copied) {
+        return std::nullopt;
+    }
+
+    // the copy is consistent, but checked all the same before it's trusted
+    const auto malformed = [this] {
+        return std::runtime_error(_name + " holds a malformed layout");
+    };
+    const auto* tables = _copy.data();
+    const auto* text   = tables + windows * sizeof(window_record_t) +
+                       elements * sizeof(element_record_t);
+    const auto string = [&](std::uint32_t offset, std::uint32_t size) {
+        if (offset > characters || size > characters - offset) {
+            throw malformed();
+        }
+        return std::string(reinterpret_cast<const char*>(text) + offset, size);
+    };
+
+    std::vector<window_spec_t> specs(windows);
+    for (std::size_t i = 0; i < windows; ++i) {
+        const auto window = get<window_record_t>(tables, i);
+        if (window.first > elements || window.elements > elements - window.first) {
+            throw malformed();
+        }
+
+        auto& spec    = specs[i];
+        spec.title    = string(window.title, window.title_size);
+        spec.geometry = window.geometry;
+        spec.elements.resize(window.elements);
+        for (std::size_t j = 0; j < window.elements; ++j) {
+            const auto element = get<element_record_t>(
+                tables + windows * sizeof(window_record_t), window.first + j);
+            if ((element.parent != scene_t::npos && element.parent >= j) ||
+                element.kind > element_kind_t::rect) {
+                throw malformed();
+            }
+
+            spec.elements[j] = {element.kind,
+                                element.parent,
+                                element.geometry,
+                                string(element.text, element.text_size)};
+        }
+    }
+
+    return std::pair{std::move(specs), sequence / 2};
+}
+}
@@ -0,0 +1,113 @@
+#pragma once
+#ifndef SK_IMPL_LAYOUT_SEGMENT_HPP
+#define SK_IMPL_LAYOUT_SEGMENT_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <sketch/geometry.hpp>
+#include <sketch/scene.hpp>
+#include <sketch/window.hpp>
+
+namespace sk::impl {
+
+// an element of a window spec, its parent comes before it
+struct element_spec_t {
+    element_kind_t kind;
+    element_id_t   parent = {scene_t::npos};
+    geometry_t     geometry;
+    std::string    text;
+};
+
+/* a window of a sketch with every expression evaluated, all it takes to
+ * create the window; elements are in the depth-first order of its scene
+ */
+struct window_spec_t {
+    std::string                 title;
+    geometry_t                  geometry;
+    std::vector<element_spec_t> elements;
+};
+
+/* window specs loaded from sketches the way load_sketches loads them, but
+ * without creating any window; defined along with load_sketches
+ */
+std::vector<window_spec_t>
+load_window_specs(
+    const std::vector<std::string>& filenames, std::ostream& diagnostics);
+
+window_t make_window(const window_spec_t&);
+void     fill_scene(scene_t&, const window_spec_t&);
+
+/* window specs in a POSIX shared memory segment, so that one process parses
+ * the sketches and any number of others create the windows: a header, then
+ * flat tables of window and element records, then the characters of their
+ * titles and texts
+ *
+ * the publishing process is the only writer and readers never write, not
+ * even a lock: a sequence number in the header is odd while the tables are
+ * written, readers copy the tables out and keep the copy only if the number
+ * was even and unchanged across the copy; the segment grows as needed,
+ * readers map it again once it has
+ *
+ * records are copied as they are, so every process has to be built from the
+ * same sources, which the header checks
+ */
+class layout_segment_t final {
+public:
+    enum class access_t : std::uint8_t { publish, follow };
+
+private:
+    struct header_t;
+
+    std::string            _name;
+    access_t               _access;
+    int                    _fd   = {-1};
+    void*                  _data = {nullptr};
+    std::size_t            _size = {0}; // mapped bytes
+    std::vector<std::byte> _copy;       // of the tables, made by read
+
+    header_t&       header();
+    const header_t& header() const;
+    void            map(std::size_t size);
+
+public:
+    /* publishers create the segment, or take over one left behind, and
+     * remove its name when they go, followers map an existing one read-only;
+     * names are those of shm_open, the leading slash may be left out
+     */
+    layout_segment_t(std::string_view name, access_t access);
+    ~layout_segment_t();
+
+    layout_segment_t(const layout_segment_t&) = delete;
+    layout_segment_t& operator=(const layout_segment_t&) = delete;
+
+    // replaces the specs, returns their generation
+    std::uint64_t publish(const std::vector<window_spec_t>&);
+
+    // of the last complete publish, 0 before the first one; a single load
+    std::uint64_t generation() const;
+
+    /* the specs of a complete publish and its generation, nullopt if every
+     * attempt overlapped with a publish
+     */
+    std::optional<std::pair<std::vector<window_spec_t>, std::uint64_t>>
+    read();
+};
+
+// windows an application created from a segment, by their position in it
+struct layout_follower_t {
+    layout_segment_t             segment;
+    std::uint64_t                generation = {0};
+    std::vector<window_handle_t> windows;
+
+    explicit layout_follower_t(std::string_view name);
+};
+}
+
+#endif // SK_IMPL_LAYOUT_SEGMENT_HPP
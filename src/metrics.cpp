@@ -0,0 +1,217 @@
+#include "metrics.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace sk::impl {
+
+namespace {
+
+constexpr auto relaxed = std::memory_order_relaxed;
+
+// the main thread is the only writer, so counters need no locked add
+template <typename ValueType>
+ValueType
+add(std::atomic<ValueType>& counter, ValueType value)
+{
+    const auto previous = counter.load(relaxed);
+    counter.store(previous + value, relaxed);
+    return previous;
+}
+}
+
+metrics_t::metrics_t() : _slots(std::make_unique<slot_t[]>(max_windows))
+{
+}
+
+metrics_t::slot_t*
+metrics_t::slot(std::uint32_t index) const
+{
+    return (index < max_windows) ? &_slots[index] : nullptr;
+}
+
+void
+metrics_t::attach(
+    std::uint32_t index, std::uint32_t generation, std::string_view title)
+{
+    add<std::size_t>(_windows, 1);
+    auto* found = slot(index);
+    if (!found) {
+        return;
+    }
+
+    // cut where a character starts, so that the title stays valid utf-8
+    if (title.size() > title_size) {
+        auto size = title_size;
+        while (size &&
+               (static_cast<unsigned char>(title[size]) & 0xc0) == 0x80) {
+            --size;
+        }
+        title = title.substr(0, size);
+    }
+
+    auto&      slot     = *found;
+    const auto sequence = slot.sequence.load(relaxed);
+    slot.sequence.store(sequence + 1, relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot.generation.store(generation, relaxed);
+    slot.live.store(true, relaxed);
+    for (std::size_t i = 0; i < slot.title.size(); ++i) {
+        std::uint64_t chars = 0;
+        if (i * 8 < title.size()) {
+            std::memcpy(&chars, title.data() + i * 8,
+                        std::min<std::size_t>(8, title.size() - i * 8));
+        }
+        slot.title[i].store(chars, relaxed);
+    }
+    slot.x.store(0, relaxed);
+    slot.y.store(0, relaxed);
+    slot.width.store(0, relaxed);
+    slot.height.store(0, relaxed);
+    slot.events.store(0, relaxed);
+    slot.frames.store(0, relaxed);
+
+    slot.sequence.store(sequence + 2, std::memory_order_release);
+}
+
+void
+metrics_t::detach(std::uint32_t index)
+{
+    add<std::size_t>(_windows, SIZE_MAX);
+    if (auto* found = slot(index)) {
+        found->live.store(false, std::memory_order_release);
+    }
+}
+
+void
+metrics_t::place(std::uint32_t index, int x, int y, int width, int height)
+{
+    auto* found = slot(index);
+    if (!found) {
+        return;
+    }
+
+    auto&      slot     = *found;
+    const auto sequence = slot.sequence.load(relaxed);
+    slot.sequence.store(sequence + 1, relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot.x.store(x, relaxed);
+    slot.y.store(y, relaxed);
+    slot.width.store(width, relaxed);
+    slot.height.store(height, relaxed);
+
+    slot.sequence.store(sequence + 2, std::memory_order_release);
+}
+
+void
+metrics_t::event(std::optional<std::uint32_t> index)
+{
+    ++_frame_events;
+    if (auto* found = index ? slot(*index) : nullptr) {
+        add<std::uint64_t>(found->events, 1);
+    }
+}
+
+void
+metrics_t::drawn(std::uint32_t index)
+{
+    ++_frame_drawn;
+    if (auto* found = slot(index)) {
+        add<std::uint64_t>(found->frames, 1);
+    }
+}
+
+void
+metrics_t::begin_frame()
+{
+    _started      = clock_t::now();
+    _frame_events = 0;
+    _frame_drawn  = 0;
+}
+
+void
+metrics_t::end_frame(const totals_t& depths)
+{
+    const auto number = add<std::uint64_t>(_frames, 1);
+    add<std::uint64_t>(_events, _frame_events);
+    _fps.store(depths.fps, relaxed);
+    _timers.store(depths.timers, relaxed);
+    _queued.store(depths.queued, relaxed);
+    _jobs.store(depths.jobs, relaxed);
+    _removed.store(depths.removed, relaxed);
+
+    const auto head = _head.load(relaxed);
+    if (head - _tail.load(std::memory_order_acquire) >= ring_size) {
+        add<std::uint64_t>(_dropped, 1);
+        return;
+    }
+
+    const auto now = clock_t::now();
+    _ring[head % ring_size] = {
+        number,
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            _started.time_since_epoch())
+            .count(),
+        std::chrono::duration_cast<std::chrono::nanoseconds>(now - _started)
+            .count(),
+        _frame_events,
+        _frame_drawn};
+    _head.store(head + 1, std::memory_order_release);
+}
+
+metrics_t::totals_t
+metrics_t::totals() const
+{
+    return {_frames.load(relaxed),
+            _events.load(relaxed),
+            _dropped.load(relaxed),
+            _fps.load(relaxed),
+            _windows.load(relaxed),
+            _timers.load(relaxed),
+            _queued.load(relaxed),
+            _jobs.load(relaxed),
+            _removed.load(relaxed)};
+}
+
+std::vector<metrics_t::window_t>
+metrics_t::windows() const
+{
+    std::vector<window_t> result;
+    for (std::uint32_t index = 0; index < max_windows; ++index) {
+        const auto& slot = _slots[index];
+        if (!slot.live.load(std::memory_order_acquire)) {
+            continue;
+        }
+
+        const auto sequence = slot.sequence.load(std::memory_order_acquire);
+        if (sequence & 1) {
+            continue;
+        }
+
+        window_t window;
+        window.index      = index;
+        window.generation = slot.generation.load(relaxed);
+        window.x          = slot.x.load(relaxed);
+        window.y          = slot.y.load(relaxed);
+        window.width      = slot.width.load(relaxed);
+        window.height     = slot.height.load(relaxed);
+        window.events     = slot.events.load(relaxed);
+        window.frames     = slot.frames.load(relaxed);
+
+        char title[title_size];
+        for (std::size_t i = 0; i < slot.title.size(); ++i) {
+            const auto chars = slot.title[i].load(relaxed);
+            std::memcpy(title + i * 8, &chars, 8);
+        }
+        window.title.assign(title, strnlen(title, title_size));
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(relaxed) == sequence) {
+            result.push_back(std::move(window));
+        }
+    }
+    return result;
+}
+}
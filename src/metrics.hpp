@@ -0,0 +1,144 @@
+#pragma once
+#ifndef SK_IMPL_METRICS_HPP
+#define SK_IMPL_METRICS_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace sk::impl {
+
+/* what the application loop measures, for introspection: written by the
+ * main thread only and read by any other thread without locks, so reading
+ * never stalls the loop
+ *
+ * counters are relaxed atomics; the fields of a window slot are atomics too
+ * and a sequence number, odd while they're written, tells readers whether
+ * they read them all of a piece; frames go through a ring buffer with a
+ * single reader, frames the reader didn't take in time are dropped rather
+ * than waited for
+ */
+class metrics_t {
+public:
+    using clock_t = std::chrono::steady_clock;
+
+    // windows in slots past this are counted, but not detailed
+    static constexpr std::size_t max_windows = {1024};
+    static constexpr std::size_t title_size  = {64}; // longer ones are cut
+    static constexpr std::size_t ring_size   = {1024};
+
+    // one iteration of the application loop
+    struct frame_t {
+        std::uint64_t number      = {0};
+        std::int64_t  started_ns  = {0}; // steady clock
+        std::int64_t  duration_ns = {0};
+        std::uint32_t events      = {0};
+        std::uint32_t drawn       = {0}; // windows
+    };
+
+    struct window_t {
+        std::uint32_t index      = {0};
+        std::uint32_t generation = {0};
+        std::string   title;
+        int           x      = {0};
+        int           y      = {0};
+        int           width  = {0};
+        int           height = {0};
+        std::uint64_t events = {0};
+        std::uint64_t frames = {0};
+    };
+
+    // queue depths and totals as of the last frame
+    struct totals_t {
+        std::uint64_t frames  = {0};
+        std::uint64_t events  = {0};
+        std::uint64_t dropped = {0}; // frames the reader missed
+        std::size_t   fps     = {0}; // frames presented, any window drawn
+        std::size_t   windows = {0};
+        std::size_t   timers  = {0};
+        std::size_t   queued  = {0}; // frame deadlines, outdated ones too
+        std::size_t   jobs    = {0};
+        std::size_t   removed = {0}; // windows yet to be destroyed
+    };
+
+private:
+    struct slot_t {
+        std::atomic<std::uint32_t> sequence   = {0};
+        std::atomic<std::uint32_t> generation = {0};
+        std::atomic<bool>          live       = {false};
+        std::atomic<int>           x          = {0};
+        std::atomic<int>           y          = {0};
+        std::atomic<int>           width      = {0};
+        std::atomic<int>           height     = {0};
+
+        // eight characters each, zero padded
+        std::array<std::atomic<std::uint64_t>, title_size / 8> title = {};
+
+        std::atomic<std::uint64_t> events = {0};
+        std::atomic<std::uint64_t> frames = {0};
+    };
+
+    std::unique_ptr<slot_t[]> _slots;
+
+    std::atomic<std::uint64_t> _frames  = {0};
+    std::atomic<std::uint64_t> _events  = {0};
+    std::atomic<std::uint64_t> _dropped = {0};
+    std::atomic<std::size_t>   _fps     = {0};
+    std::atomic<std::size_t>   _windows = {0};
+    std::atomic<std::size_t>   _timers  = {0};
+    std::atomic<std::size_t>   _queued  = {0};
+    std::atomic<std::size_t>   _jobs    = {0};
+    std::atomic<std::size_t>   _removed = {0};
+
+    // written up to _head by the main thread, read up to _tail by the reader
+    std::array<frame_t, ring_size> _ring;
+    std::atomic<std::uint64_t>     _head = {0};
+    std::atomic<std::uint64_t>     _tail = {0};
+
+    // frame in progress, main thread only
+    clock_t::time_point _started      = {clock_t::now()};
+    std::uint32_t       _frame_events = {0};
+    std::uint32_t       _frame_drawn  = {0};
+
+    slot_t* slot(std::uint32_t index) const;
+
+public:
+    metrics_t();
+
+    // main thread, slots are those of the window registry
+    void attach(
+        std::uint32_t index, std::uint32_t generation, std::string_view title);
+    void detach(std::uint32_t index);
+    void place(std::uint32_t index, int x, int y, int width, int height);
+    void event(std::optional<std::uint32_t> index); // of a window, if any
+    void drawn(std::uint32_t index);
+
+    void begin_frame();
+    void end_frame(const totals_t& depths); // its counts are ignored
+
+    // any thread
+    totals_t              totals() const;
+    std::vector<window_t> windows() const; // torn slots are skipped
+
+    // a single thread, calls take(frame) for every frame since the last call
+    template <typename FuncType>
+    void
+    take_frames(FuncType&& take)
+    {
+        const auto tail = _tail.load(std::memory_order_relaxed);
+        const auto head = _head.load(std::memory_order_acquire);
+        for (auto i = tail; i != head; ++i) {
+            take(_ring[i % ring_size]);
+        }
+        _tail.store(head, std::memory_order_release);
+    }
+};
+}
+
+#endif // SK_IMPL_METRICS_HPP
@@ -0,0 +1,88 @@
+#include "parser.hpp"
+
+#include <cstddef>
+#include <stdexcept>
+#include <string_view>
+
+#include "grammar.hpp"
+
+namespace sk::impl {
+
+namespace {
+
+// the grammar recurses into brackets, deeper nesting could overflow the stack
+constexpr std::size_t max_nesting = {256};
+
+/* where brackets first nest deeper than that, quoted strings and comments
+ * aside; null if they never do
+ */
+const char*
+too_deep(std::string_view input)
+{
+    std::size_t depth = 0;
+    for (std::size_t i = 0; i < input.size(); ++i) {
+        // on to the last character of the end, or past the input
+        const auto skip_to = [&](std::string_view end, std::size_t from) {
+            const auto found = input.find(end, from);
+            i = (found == std::string_view::npos) ? input.size()
+                                                  : found + end.size() - 1;
+        };
+
+        switch (input[i]) {
+        case '\'':
+        case '"': skip_to(input.substr(i, 1), i + 1); break;
+        case '/':
+            if (input.substr(i, 2) == "/*") {
+                skip_to("*/", i + 2);
+            } else if (input.substr(i, 2) == "//") {
+                // ends at a line ending of any kind, as the skipper's eol
+                const auto end = input.find_first_of("\r\n", i + 2);
+                i = (end == std::string_view::npos) ? input.size() : end;
+            }
+            break;
+        case '(':
+        case '{':
+            if (++depth > max_nesting) {
+                return input.data() + i;
+            }
+            break;
+        case ')':
+        case '}': depth = depth ? depth - 1 : 0; break;
+        default: break;
+        }
+    }
+    return nullptr;
+}
+}
+
+file_ast
+parse_sketch(
+    std::string_view input,
+    std::ostream&    diagnostics,
+    std::string      filename)
+{
+    error_handler_t error_handler(input, diagnostics, std::move(filename));
+    if (const auto* where = too_deep(input)) {
+        error_handler(where, "error! nesting too deep here: ");
+        throw std::runtime_error("parsing error");
+    }
+
+    auto       first  = input.data();
+    const auto last   = input.data() + input.size();
+    const auto parser = x3::with<error_handler_tag>(
+        std::ref(error_handler))[grammar::file];
+
+    file_ast result;
+    if (!x3::phrase_parse(first, last, parser, grammar::skipper, result) ||
+        first != last) {
+        // failed rules have said what they expected, unless none did
+        if (!error_handler.reported()) {
+            error_handler(
+                first, "error! expecting: include, let or window here: ");
+        }
+        throw std::runtime_error("parsing error");
+    }
+
+    return result;
+}
+}
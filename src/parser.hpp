@@ -0,0 +1,24 @@
+#pragma once
+#ifndef SK_IMPL_PARSER_HPP
+#define SK_IMPL_PARSER_HPP
+
+#include <iosfwd>
+#include <string>
+#include <string_view>
+
+#include "sketch_ast.hpp"
+
+namespace sk::impl {
+
+/* parses a whole file, problems are reported to the stream along with
+ * where they are and the parse then fails with std::runtime_error; the
+ * filename is only used in the reports; positions in the result point into
+ * the input, which has to outlive it
+ */
+file_ast parse_sketch(
+    std::string_view input,
+    std::ostream&    diagnostics,
+    std::string      filename = {});
+}
+
+#endif // SK_IMPL_PARSER_HPP
@@ -0,0 +1,221 @@
+#include "raster.hpp"
+
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define SK_RASTER_AVX2
+#include <immintrin.h>
+#endif
+
+namespace sk::impl {
+
+namespace {
+
+std::uint32_t
+blend_channel(std::uint32_t src_alpha, std::uint32_t dst, std::uint32_t inv)
+{
+    // src_alpha is s * a + 128, the division by 255 is exact for 16 bits
+    const auto t = src_alpha + dst * inv;
+    return (t + (t >> 8u)) >> 8u;
+}
+
+void
+fill_scalar(std::uint32_t* dst, std::size_t count, std::uint32_t pixel)
+{
+    for (std::size_t i = 0; i < count; ++i) {
+        dst[i] = pixel;
+    }
+}
+
+void
+blend_scalar(
+    std::uint32_t* dst,
+    std::size_t    count,
+    std::uint32_t  pixel,
+    std::uint8_t   alpha)
+{
+    const std::uint32_t inv = 255u - alpha;
+
+    std::uint32_t src[4];
+    for (unsigned c = 0; c < 4; ++c) {
+        src[c] = ((pixel >> (c * 8u)) & 0xffu) * alpha + 128u;
+    }
+
+    for (std::size_t i = 0; i < count; ++i) {
+        std::uint32_t result = 0;
+        for (unsigned c = 0; c < 4; ++c) {
+            result |= blend_channel(src[c], (dst[i] >> (c * 8u)) & 0xffu, inv)
+                      << (c * 8u);
+        }
+        dst[i] = result;
+    }
+}
+
+void
+copy_scalar(std::uint32_t* dst, const std::uint32_t* src, std::size_t count)
+{
+    for (std::size_t i = 0; i < count; ++i) {
+        dst[i] = src[i];
+    }
+}
+
+#if defined(__SSE2__)
+void
+fill_sse2(std::uint32_t* dst, std::size_t count, std::uint32_t pixel)
+{
+    const auto  value = _mm_set1_epi32(static_cast<int>(pixel));
+    std::size_t i     = 0;
+    for (; i + 4 <= count; i += 4) {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), value);
+    }
+    fill_scalar(dst + i, count - i, pixel);
+}
+
+void
+blend_sse2(
+    std::uint32_t* dst,
+    std::size_t    count,
+    std::uint32_t  pixel,
+    std::uint8_t   alpha)
+{
+    const auto zero = _mm_setzero_si128();
+    const auto inv  = _mm_set1_epi16(static_cast<short>(255 - alpha));
+    const auto src  = _mm_add_epi16(
+        _mm_mullo_epi16(
+            _mm_unpacklo_epi8(_mm_set1_epi32(static_cast<int>(pixel)), zero),
+            _mm_set1_epi16(alpha)),
+        _mm_set1_epi16(128));
+    const auto divide = [](__m128i t) {
+        return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+    };
+
+    std::size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        auto* at = reinterpret_cast<__m128i*>(dst + i);
+        const auto d  = _mm_loadu_si128(at);
+        const auto lo = divide(_mm_add_epi16(
+            src, _mm_mullo_epi16(_mm_unpacklo_epi8(d, zero), inv)));
+        const auto hi = divide(_mm_add_epi16(
+            src, _mm_mullo_epi16(_mm_unpackhi_epi8(d, zero), inv)));
+        _mm_storeu_si128(at, _mm_packus_epi16(lo, hi));
+    }
+    blend_scalar(dst + i, count - i, pixel, alpha);
+}
+
+void
+copy_sse2(std::uint32_t* dst, const std::uint32_t* src, std::size_t count)
+{
+    std::size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        _mm_storeu_si128(
+            reinterpret_cast<__m128i*>(dst + i),
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)));
+    }
+    copy_scalar(dst + i, src + i, count - i);
+}
+#endif
+
+#if defined(SK_RASTER_AVX2)
+__attribute__((target("avx2"))) void
+fill_avx2(std::uint32_t* dst, std::size_t count, std::uint32_t pixel)
+{
+    const auto  value = _mm256_set1_epi32(static_cast<int>(pixel));
+    std::size_t i     = 0;
+    for (; i + 8 <= count; i += 8) {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), value);
+    }
+    fill_scalar(dst + i, count - i, pixel);
+}
+
+__attribute__((target("avx2"))) __m256i
+divide_by_255(__m256i t)
+{
+    return _mm256_srli_epi16(_mm256_add_epi16(t, _mm256_srli_epi16(t, 8)), 8);
+}
+
+__attribute__((target("avx2"))) void
+blend_avx2(
+    std::uint32_t* dst,
+    std::size_t    count,
+    std::uint32_t  pixel,
+    std::uint8_t   alpha)
+{
+    // unpacking and packing both work within 128-bit lanes, so pixels keep
+    // their order
+    const auto zero = _mm256_setzero_si256();
+    const auto inv  = _mm256_set1_epi16(static_cast<short>(255 - alpha));
+    const auto src  = _mm256_add_epi16(
+        _mm256_mullo_epi16(
+            _mm256_unpacklo_epi8(
+                _mm256_set1_epi32(static_cast<int>(pixel)), zero),
+            _mm256_set1_epi16(alpha)),
+        _mm256_set1_epi16(128));
+
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        auto* at = reinterpret_cast<__m256i*>(dst + i);
+        const auto d  = _mm256_loadu_si256(at);
+        const auto lo = divide_by_255(_mm256_add_epi16(
+            src, _mm256_mullo_epi16(_mm256_unpacklo_epi8(d, zero), inv)));
+        const auto hi = divide_by_255(_mm256_add_epi16(
+            src, _mm256_mullo_epi16(_mm256_unpackhi_epi8(d, zero), inv)));
+        _mm256_storeu_si256(at, _mm256_packus_epi16(lo, hi));
+    }
+    blend_scalar(dst + i, count - i, pixel, alpha);
+}
+
+__attribute__((target("avx2"))) void
+copy_avx2(std::uint32_t* dst, const std::uint32_t* src, std::size_t count)
+{
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        _mm256_storeu_si256(
+            reinterpret_cast<__m256i*>(dst + i),
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i)));
+    }
+    copy_scalar(dst + i, src + i, count - i);
+}
+#endif
+
+std::vector<raster_kernels_t>
+detect()
+{
+    std::vector<raster_kernels_t> result = {
+        {"scalar", fill_scalar, blend_scalar, copy_scalar}};
+#if defined(__SSE2__)
+    result.push_back({"sse2", fill_sse2, blend_sse2, copy_sse2});
+#endif
+#if defined(SK_RASTER_AVX2)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        result.push_back({"avx2", fill_avx2, blend_avx2, copy_avx2});
+    }
+#endif
+    return result;
+}
+
+const std::vector<raster_kernels_t>&
+supported()
+{
+    static const auto result = detect();
+    return result;
+}
+}
+
+const raster_kernels_t&
+raster_kernels()
+{
+    static const auto& best = supported().back();
+    return best;
+}
+
+std::span<const raster_kernels_t>
+supported_raster_kernels()
+{
+    return supported();
+}
+}
@@ -0,0 +1,37 @@
+#pragma once
+#ifndef SK_IMPL_RASTER_HPP
+#define SK_IMPL_RASTER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+namespace sk::impl {
+
+/* row kernels of the software rasterizer, they work on 32-bit pixels of any
+ * channel order as long as every channel is a byte; blending is
+ * d = (s * a + d * (255 - a)) / 255, rounded, on every channel, and gives
+ * the same result on every instruction set
+ */
+struct raster_kernels_t {
+    std::string_view isa;
+
+    void (*fill)(std::uint32_t* dst, std::size_t count, std::uint32_t pixel);
+    void (*blend)(
+        std::uint32_t* dst,
+        std::size_t    count,
+        std::uint32_t  pixel,
+        std::uint8_t   alpha);
+    void (*copy)(
+        std::uint32_t* dst, const std::uint32_t* src, std::size_t count);
+};
+
+// the best kernels the cpu supports, picked on first use
+const raster_kernels_t& raster_kernels();
+
+// every set the cpu supports, the scalar reference first
+std::span<const raster_kernels_t> supported_raster_kernels();
+}
+
+#endif // SK_IMPL_RASTER_HPP
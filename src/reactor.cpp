@@ -11,8 +11,7 @@ namespace {
 void
 default_on_draw(gsl::not_null<window_t*>)
 {
-    // do nothing
-    std::cout << __FUNCTION__ << '\n';
+    // do nothing, it's called every frame
 }
 
 void
@@ -31,6 +30,18 @@ default_on_keydown(
     std::cout << __FUNCTION__ << '\n';
 }
 
+void
+default_on_key(gsl::not_null<window_t*>, const key_event_t&)
+{
+    // do nothing
+}
+
+void
+default_on_text(gsl::not_null<window_t*>, std::string_view)
+{
+    // do nothing
+}
+
 void
 default_on_mouse_move(
     gsl::not_null<window_t*>,
@@ -39,13 +50,68 @@ default_on_mouse_move(
     // do nothing
     std::cout << __FUNCTION__ << '\n';
 }
+
+void
+default_on_close(gsl::not_null<window_t*> window)
+{
+    // only this window goes away, the application quits with the last one
+    window->close();
+}
+
+void
+default_on_window_event(gsl::not_null<window_t*>)
+{
+    // do nothing
+}
+
+void
+default_on_focus(gsl::not_null<window_t*>, [[maybe_unused]] bool gained)
+{
+    // do nothing
+}
+
+void
+default_on_resize(
+    gsl::not_null<window_t*>,
+    [[maybe_unused]] const std::tuple<std::size_t, std::size_t>& size)
+{
+    // do nothing
+}
+
+void
+default_on_element(gsl::not_null<window_t*>, element_id_t)
+{
+    // do nothing
+}
+
+void
+default_on_hover(
+    gsl::not_null<window_t*>,
+    element_id_t,
+    [[maybe_unused]] const std::tuple<std::size_t, std::size_t>& point)
+{
+    // do nothing
+}
 }
 
 reactor_t::reactor_t()
     : _on_draw(default_on_draw),
       _on_quit(default_on_quit),
       _on_keydown(default_on_keydown),
-      _on_mouse_move(default_on_mouse_move)
+      _on_key(default_on_key),
+      _on_text(default_on_text),
+      _on_mouse_move(default_on_mouse_move),
+      _on_close(default_on_close),
+      _on_show(default_on_window_event),
+      _on_hide(default_on_window_event),
+      _on_minimize(default_on_window_event),
+      _on_restore(default_on_window_event),
+      _on_expose(default_on_window_event),
+      _on_focus(default_on_focus),
+      _on_resize(default_on_resize),
+      _on_enter(default_on_element),
+      _on_leave(default_on_element),
+      _on_hover(default_on_hover)
 {
 }
 
@@ -67,9 +133,88 @@ reactor_t::on_keydown(std::size_t keycode)
     _on_keydown(_window, keycode);
 }
 
+void
+reactor_t::on_key(const key_event_t& event)
+{
+    _on_key(_window, event);
+}
+
+void
+reactor_t::on_text(std::string_view utf8)
+{
+    _on_text(_window, utf8);
+}
+
 void
 reactor_t::on_mouse_move(const std::tuple<std::size_t, std::size_t>& point)
 {
     _on_mouse_move(_window, point);
 }
+
+void
+reactor_t::on_close()
+{
+    _on_close(_window);
+}
+
+void
+reactor_t::on_show()
+{
+    _on_show(_window);
+}
+
+void
+reactor_t::on_hide()
+{
+    _on_hide(_window);
+}
+
+void
+reactor_t::on_minimize()
+{
+    _on_minimize(_window);
+}
+
+void
+reactor_t::on_restore()
+{
+    _on_restore(_window);
+}
+
+void
+reactor_t::on_expose()
+{
+    _on_expose(_window);
+}
+
+void
+reactor_t::on_focus(bool gained)
+{
+    _on_focus(_window, gained);
+}
+
+void
+reactor_t::on_resize(const std::tuple<std::size_t, std::size_t>& size)
+{
+    _on_resize(_window, size);
+}
+
+void
+reactor_t::on_enter(element_id_t element)
+{
+    _on_enter(_window, element);
+}
+
+void
+reactor_t::on_leave(element_id_t element)
+{
+    _on_leave(_window, element);
+}
+
+void
+reactor_t::on_hover(
+    element_id_t element, const std::tuple<std::size_t, std::size_t>& point)
+{
+    _on_hover(_window, element, point);
+}
 }
@@ -0,0 +1,210 @@
+#include <sketch/scene.hpp>
+
+#include <stdexcept>
+
+#include "hit_index.hpp"
+#include "layout_engine.hpp"
+
+namespace sk {
+
+scene_t::scene_t()                   = default;
+scene_t::scene_t(scene_t&&) noexcept = default;
+scene_t& scene_t::operator=(scene_t&&) noexcept = default;
+scene_t::~scene_t()                             = default;
+
+element_id_t
+scene_t::add(
+    element_kind_t    kind,
+    element_id_t      parent,
+    const geometry_t& geometry,
+    std::string       text)
+{
+    const auto id = static_cast<element_id_t>(_kinds.size());
+    if (parent != npos && (parent >= id || _ends[parent] != id)) {
+        throw std::invalid_argument(
+            "scene elements have to be added depth-first");
+    }
+
+    _kinds.push_back(kind);
+    _parents.push_back(parent);
+    _ends.push_back(id + 1);
+    _geometry.push_back(geometry);
+    _texts.push_back(std::move(text));
+    _x.push_back(0);
+    _y.push_back(0);
+    _w.push_back(0);
+    _h.push_back(0);
+
+    // the new element extends the subtree of every ancestor
+    for (auto ancestor = parent; ancestor != npos;
+         ancestor      = _parents[ancestor]) {
+        _ends[ancestor] = id + 1;
+    }
+
+    _dirty = true;
+    return id;
+}
+
+void
+scene_t::clear()
+{
+    _kinds.clear();
+    _parents.clear();
+    _ends.clear();
+    _geometry.clear();
+    _texts.clear();
+    _x.clear();
+    _y.clear();
+    _w.clear();
+    _h.clear();
+    _dirty   = false;
+    _indexed = false;
+}
+
+std::size_t
+scene_t::size() const
+{
+    return _kinds.size();
+}
+
+bool
+scene_t::empty() const
+{
+    return _kinds.empty();
+}
+
+element_kind_t
+scene_t::kind(element_id_t id) const
+{
+    return _kinds.at(id);
+}
+
+element_id_t
+scene_t::parent(element_id_t id) const
+{
+    return _parents.at(id);
+}
+
+element_id_t
+scene_t::end(element_id_t id) const
+{
+    return _ends.at(id);
+}
+
+std::string_view
+scene_t::text(element_id_t id) const
+{
+    return _texts.at(id);
+}
+
+const geometry_t&
+scene_t::geometry(element_id_t id) const
+{
+    return _geometry.at(id);
+}
+
+void
+scene_t::geometry(element_id_t id, const geometry_t& geometry)
+{
+    _geometry.at(id) = geometry;
+    _dirty           = true;
+}
+
+void
+scene_t::resize(int width, int height)
+{
+    if (width != _width || height != _height) {
+        _width  = width;
+        _height = height;
+        _dirty  = true;
+    }
+}
+
+void
+scene_t::layout()
+{
+    if (!_dirty) {
+        return;
+    }
+
+    using layout_t = impl::layout_engine_t;
+
+    const layout_t::rect_t window = {0, 0, _width, _height};
+    for (std::size_t i = 0; i < _kinds.size(); ++i) {
+        // parents come first, so theirs are resolved already
+        const auto parent = _parents[i];
+        const auto bounds = (parent == npos) ? window
+                                             : layout_t::rect_t{_x[parent],
+                                                                _y[parent],
+                                                                _w[parent],
+                                                                _h[parent]};
+
+        const auto rect = layout_t::resolve(_geometry[i], bounds);
+        _x[i] = (rect.x == layout_t::unset) ? bounds.x : rect.x;
+        _y[i] = (rect.y == layout_t::unset) ? bounds.y : rect.y;
+        _w[i] = rect.w;
+        _h[i] = rect.h;
+    }
+
+    _dirty   = false;
+    _indexed = false;
+}
+
+bool
+scene_t::dirty() const
+{
+    return _dirty;
+}
+
+element_id_t
+scene_t::hit_test(int x, int y)
+{
+    layout();
+    if (!_indexed) {
+        if (!_index) {
+            _index = std::make_unique<impl::hit_index_t>();
+        }
+        _index->build(_x, _y, _w, _h, _width, _height);
+        _indexed = true;
+    }
+
+    const auto found = _index->find(x, y);
+    return (found == impl::hit_index_t::npos) ? npos : found;
+}
+
+std::span<const element_id_t>
+scene_t::parents() const
+{
+    return _parents;
+}
+
+std::span<const element_kind_t>
+scene_t::kinds() const
+{
+    return _kinds;
+}
+
+std::span<const int>
+scene_t::x() const
+{
+    return _x;
+}
+
+std::span<const int>
+scene_t::y() const
+{
+    return _y;
+}
+
+std::span<const int>
+scene_t::w() const
+{
+    return _w;
+}
+
+std::span<const int>
+scene_t::h() const
+{
+    return _h;
+}
+}
@@ -16,4 +16,26 @@ get_bounds(int display_index)
 
     throw std::runtime_error(SDL_GetError());
 }
+
+layout_engine_t::rect_t
+get_rect(int display_index)
+{
+    SDL_Rect result;
+    if (!SDL_GetDisplayBounds(display_index, &result)) {
+        return {result.x, result.y, result.w, result.h};
+    }
+
+    throw std::runtime_error(SDL_GetError());
+}
+
+std::size_t
+count()
+{
+    const auto result = SDL_GetNumVideoDisplays();
+    if (result < 0) {
+        throw std::runtime_error(SDL_GetError());
+    }
+
+    return static_cast<std::size_t>(result);
+}
 }
@@ -5,10 +5,17 @@
 #include <cstdint>
 #include <tuple>
 
+#include "layout_engine.hpp"
+
 namespace sk::impl::sdl2::display {
 
 std::tuple<std::size_t, std::size_t, std::size_t, std::size_t>
 get_bounds(int display_index = 0);
+
+// same as get_bounds, but keeps negative origins of secondary displays
+layout_engine_t::rect_t get_rect(int display_index = 0);
+
+std::size_t count();
 }
 
 #endif // SK_IMPL_SDL2_DISPLAY_HPP
@@ -0,0 +1,296 @@
+#include "sketch_ast.hpp"
+
+#include <cassert>
+#include <exception>
+#include <iostream>
+#include <iterator>
+#include <utility>
+
+namespace sk::impl {
+
+using namespace std::literals::string_literals;
+
+namespace {
+
+// expressions are shown as written, the flag stands for full or centered
+template <typename ValueType>
+std::string
+describe(const ValueType& value, const char* flag)
+{
+    if (!value) {
+        return "undefined";
+    }
+
+    if (std::holds_alternative<bool>(*value)) {
+        return flag;
+    }
+
+    return std::get<expression_ast>(*value).text;
+}
+}
+
+// every rule of the grammar appends what the one below it parsed, the nodes
+// are moved along rather than copied at every level
+void
+expression_ast::append(expression_ast&& operand)
+{
+    if (nodes.empty()) {
+        nodes = std::move(operand.nodes);
+        return;
+    }
+
+    nodes.insert(
+        nodes.end(),
+        std::make_move_iterator(operand.nodes.begin()),
+        std::make_move_iterator(operand.nodes.end()));
+}
+
+void
+expression_ast::apply(op_t op, const char* where)
+{
+    nodes.push_back({op, 0, {}, where});
+}
+
+const char*
+region_ast::what() const
+{
+    if (!_kind) {
+        return "window";
+    }
+
+    switch (*_kind) {
+    case element_kind_t::panel: return "panel";
+    case element_kind_t::label: return "label";
+    default: return "rect";
+    }
+}
+
+void
+region_ast::set_kind(element_kind_t kind)
+{
+    _kind = kind;
+}
+
+std::optional<element_kind_t>
+region_ast::get_kind() const
+{
+    return _kind;
+}
+
+void
+region_ast::add_child(region_ast&& child)
+{
+    _children.push_back(std::move(child));
+}
+
+const std::vector<region_ast>&
+region_ast::get_children() const
+{
+    return _children;
+}
+
+std::string
+region_ast::set_title(const std::string& t)
+{
+    if (!_title.empty()) {
+        return "title is already set";
+    }
+
+    _title = t;
+    return {};
+}
+
+std::string
+region_ast::get_title() const
+{
+    return _title;
+}
+
+std::string
+region_ast::set_width(const width_t& p)
+{
+    if (_width) {
+        return "width is already set";
+    }
+
+    if (_fullscreen) {
+        return "you can't set window width since it's fullscreen";
+    }
+
+    _width = p;
+    return {};
+}
+
+width_t
+region_ast::get_width() const
+{
+    return _width;
+}
+
+std::string
+region_ast::set_height(const height_t& p)
+{
+    if (_height) {
+        return "height is already set";
+    }
+
+    if (_fullscreen) {
+        return "you can't set window height since it's fullscreen";
+    }
+
+    _height = p;
+    return {};
+}
+
+height_t
+region_ast::get_height() const
+{
+    return _height;
+}
+
+std::string
+region_ast::set_position(const position_t& p)
+{
+    assert(p);
+    if (_position) {
+        return "position is already set";
+    }
+
+    if (_fullscreen) {
+        return "you can't set window position since it's fullscreen";
+    }
+
+    const auto centered = std::holds_alternative<bool>(*p);
+    const auto screen_wide =
+        _width && std::holds_alternative<bool>(*_width);
+    if (centered && screen_wide) {
+        return "you can't set "s + what() + " position to centered since " +
+               what() + " is screen-wide";
+    }
+
+    const auto screen_high =
+        _height && std::holds_alternative<bool>(*_height);
+    if (centered && screen_high) {
+        return "you can't set "s + what() + " position to centered since " +
+               what() + " is screen-high";
+    }
+
+    const auto h_pos = std::holds_alternative<point_t>(*p);
+    if (h_pos && screen_wide) {
+        return "you can't set "s + what() + " horizontal position since " +
+               what() + " is screen-wide";
+    }
+
+    const auto v_pos = std::holds_alternative<point_t>(*p);
+    if (v_pos && screen_high) {
+        return "you can't set "s + what() + " vertical position since " +
+               what() + " is screen-high";
+    }
+
+    _position = p;
+    return {};
+}
+
+std::tuple<horizontal_t, vertical_t>
+region_ast::get_position() const
+{
+    auto pos_x = horizontal_t();
+    auto pos_y = vertical_t();
+    if (_position) {
+        if (std::holds_alternative<bool>(*_position)) {
+            pos_x = pos_y = true; // centered
+        } else {
+            return std::get<point_t>(*_position);
+        }
+    }
+
+    return std::tuple{pos_x, pos_y};
+}
+
+std::string
+region_ast::set_fullscreen()
+{
+    if (_kind) {
+        return "only windows can be fullscreen";
+    }
+
+    if (_fullscreen) {
+        return "window is already set to fullscreen";
+    }
+
+    if (_width || _height || _position) {
+        return "you can't set window to fullscreen as you already set width, "
+               "height or position attribute";
+    }
+
+    _fullscreen = true;
+    return {};
+}
+
+std::string
+region_ast::set_attribute(const attribute_t& attribute)
+{
+    // a line declares one attribute only
+    const auto& [width, height, position, fullscreen] = attribute;
+    if (width) {
+        return set_width(width);
+    }
+    if (height) {
+        return set_height(height);
+    }
+    if (position) {
+        return set_position(position);
+    }
+    if (fullscreen) {
+        return set_fullscreen();
+    }
+    return {};
+}
+
+void
+region_ast::print_children(std::size_t depth) const
+{
+    for (const auto& child : _children) {
+        child.print(depth + 1);
+    }
+}
+
+void
+region_ast::print(std::size_t depth) const try {
+    const auto indent = std::string(depth, '\t');
+    std::cout << indent << what() << R"( ")" << _title << "\"\n";
+
+    if (_fullscreen) {
+        std::cout << indent << "\tfullscreen\n";
+        print_children(depth);
+        return;
+    }
+
+    std::cout << indent << "\twidth = " << describe(_width, "screen-wide")
+              << "\n";
+    std::cout << indent << "\theight = " << describe(_height, "screen-high")
+              << "\n";
+
+    std::string position_str = "undefined";
+    if (_position) {
+        if (std::holds_alternative<bool>(*_position)) {
+            position_str = "centered";
+        } else {
+            const auto pos = std::get<point_t>(*_position);
+            if (pos.first && std::holds_alternative<bool>(*pos.first) &&
+                pos.second && std::holds_alternative<bool>(*pos.second)) {
+                position_str = "centered";
+            } else {
+                position_str = "position = { " +
+                               describe(pos.first, "h-centered") + ", " +
+                               describe(pos.second, "v-centered") + " }";
+            }
+        }
+    }
+    std::cout << indent << '\t' << position_str << '\n';
+    print_children(depth);
+} catch (std::exception& e) {
+    std::cerr << "error: " << e.what() << std::endl;
+    throw;
+}
+}
@@ -0,0 +1,147 @@
+#pragma once
+#ifndef SK_IMPL_SKETCH_AST_HPP
+#define SK_IMPL_SKETCH_AST_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include <sketch/scene.hpp>
+
+namespace sk::impl {
+
+using fullscreen_t = std::optional<bool>; // if true, then window is
+                                          // fullscreened
+
+/* arithmetic over lengths as written, e.g. 50% - 2 * gutter, kept in
+ * postfix order; names are looked up once the whole sketch and what it
+ * includes are known, see sketch_loader_t
+ */
+struct expression_ast {
+    enum class op_t : std::uint8_t {
+        number,
+        pixels,
+        percent,
+        name,
+        add,
+        subtract,
+        multiply,
+        divide,
+        negate
+    };
+
+    struct node_t {
+        op_t        op    = {op_t::number};
+        double      value = {0};       // of literals
+        std::string name  = {};        // of names
+        const char* where = {nullptr}; // in the source, for diagnostics
+    };
+
+    std::vector<node_t> nodes;
+    std::string         text; // as written
+
+    void append(expression_ast&& operand); // its nodes are taken
+    void apply(op_t, const char* where);
+};
+
+/* window width type can be undefined or specified to be screen-wide, or
+ * given by an expression
+ */
+using width_t = std::optional<std::variant<bool, expression_ast>>;
+
+/* window height type can be undefined or specified to be screen-high, or
+ * given by an expression
+ */
+using height_t = std::optional<std::variant<bool, expression_ast>>;
+
+/* horizontal window coordinates can be given by an expression, or window can
+ * be simply centered horizontally
+ */
+using horizontal_t = std::optional<std::variant<bool, expression_ast>>;
+
+/* vertical window coordinates can be given by an expression, or window can
+ * be simply centered vertically
+ */
+using vertical_t = std::optional<std::variant<bool, expression_ast>>;
+
+// point for window is represented by a pair of window coordinates
+using point_t = std::pair<horizontal_t, vertical_t>;
+
+/* window position is represented by a point or window can be simply
+ * centered both horizontally and vertically */
+using position_t = std::optional<std::variant<bool, point_t>>;
+
+// one attribute line, only the attribute it declares is set
+using attribute_t = std::tuple<width_t, height_t, position_t, fullscreen_t>;
+
+/* a window or one of the elements nested in it, they're described by the
+ * same attributes; elements are flattened into the window's scene once
+ * parsed
+ */
+class region_ast {
+    std::optional<element_kind_t> _kind; // none for the window itself
+    std::string                   _title;
+    width_t                       _width;
+    height_t                      _height;
+    position_t                    _position;
+    fullscreen_t                  _fullscreen;
+    std::vector<region_ast>       _children;
+
+    void print_children(std::size_t depth) const;
+
+public:
+    const char* what() const;
+
+    void                          set_kind(element_kind_t);
+    std::optional<element_kind_t> get_kind() const;
+
+    void                           add_child(region_ast&&);
+    const std::vector<region_ast>& get_children() const;
+
+    // setters return why they reject a value, nothing if they accept it
+    std::string set_title(const std::string&);
+    std::string get_title() const;
+
+    std::string set_width(const width_t&);
+    width_t     get_width() const;
+    std::string set_height(const height_t&);
+    height_t    get_height() const;
+
+    std::string                          set_position(const position_t&);
+    std::tuple<horizontal_t, vertical_t> get_position() const;
+
+    std::string set_fullscreen();
+    std::string set_attribute(const attribute_t&);
+
+    void print(std::size_t depth = 0) const;
+};
+
+// include 'common.sketch', relative to the including file
+struct include_ast {
+    std::string path;
+    const char* where = {nullptr};
+};
+
+// let name = expression
+struct definition_ast {
+    std::string    name;
+    expression_ast value;
+    const char*    where = {nullptr};
+};
+
+/* a whole file, includes and definitions come first; sketches go on to
+ * describe a window, files meant to be included usually stop there
+ */
+struct file_ast {
+    std::vector<include_ast>    includes;
+    std::vector<definition_ast> definitions;
+    std::optional<region_ast>   window;
+};
+}
+
+#endif // SK_IMPL_SKETCH_AST_HPP
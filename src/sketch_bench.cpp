@@ -0,0 +1,1063 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <experimental/filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <SDL.h>
+
+#include <sketch/scene.hpp>
+
+#include "capture.hpp"
+#include "chord_table.hpp"
+#include "event_log.hpp"
+#include "hit_index.hpp"
+#include "introspection_server.hpp"
+#include "layout_engine.hpp"
+#include "layout_segment.hpp"
+#include "metrics.hpp"
+#include "parser.hpp"
+#include "raster.hpp"
+
+/* micro-benchmarks of the library internals, configure with
+ * -DSKETCH_BENCHMARKS=ON; runs every benchmark or only the named ones:
+ *
+ *     sketch_bench [relayout scene hit_test raster keys parse corpus wall
+ *                   introspect capture replay ...]
+ *
+ * the corpus benchmark fails the run if parsing any input scales worse than
+ * linearly, SKETCH_CORPUS names another corpus than fuzz/corpus; the wall
+ * benchmark fails it if a process reads a layout segment mid-publish, the
+ * replay one if a recorded delay doesn't come back from the event log
+ */
+
+#ifndef SKETCH_CORPUS_DIR
+#define SKETCH_CORPUS_DIR "fuzz/corpus"
+#endif
+
+using namespace std::chrono_literals;
+
+// allocations made by the process, see sketch_bench_allocations.cpp
+extern std::size_t allocations;
+
+namespace {
+
+using bench_clock_t = std::chrono::steady_clock;
+
+// keeps results alive so the measured work isn't optimized away
+volatile std::size_t sink = {0};
+
+// runs the body until the budget is spent, returns nanoseconds per run
+template <typename FuncType>
+double
+measure(FuncType&& body, std::chrono::milliseconds budget = 200ms)
+{
+    std::size_t runs    = 0;
+    const auto  started = bench_clock_t::now();
+    auto        elapsed = bench_clock_t::duration::zero();
+    do {
+        for (std::size_t i = 0; i < 64; ++i) {
+            body();
+        }
+        runs += 64;
+        elapsed = bench_clock_t::now() - started;
+    } while (elapsed < budget);
+
+    return std::chrono::duration<double, std::nano>(elapsed).count() /
+           static_cast<double>(runs);
+}
+
+void
+report(std::string_view what, double ns, std::string_view unit = "pass")
+{
+    std::cout << "  " << std::left << std::setw(44) << what << std::right
+              << std::fixed << std::setprecision(1) << std::setw(12) << ns
+              << " ns/" << unit << '\n';
+}
+
+void
+bench_relayout()
+{
+    constexpr std::uint32_t windows = {1000};
+
+    using sk::length_t;
+    using layout_t = sk::impl::layout_engine_t;
+
+    layout_t layout;
+    layout.parent_bounds(0, {0, 0, 1920, 1080});
+    layout.parent_bounds(1, {1920, 0, 1280, 1024}); // no windows on it
+
+    // a mix of what sketches declare: percents, pixels and centering
+    for (std::uint32_t i = 0; i < windows; ++i) {
+        sk::geometry_t geometry;
+        switch (i % 3) {
+        case 0:
+            geometry = {length_t::centered(),
+                        length_t::centered(),
+                        length_t::fraction(0.5),
+                        length_t::fraction(0.25)};
+            break;
+        case 1:
+            geometry = {length_t::fraction(0.1),
+                        length_t::fraction(0.2),
+                        length_t::pixels(640),
+                        length_t::pixels(480)};
+            break;
+        default:
+            geometry = {length_t::pixels(i % 100),
+                        length_t::pixels(i % 50),
+                        length_t::full(),
+                        length_t::fraction(0.75)};
+            break;
+        }
+        layout.attach(i, geometry);
+    }
+
+    const auto apply = [](std::uint32_t, const layout_t::rect_t& rect) {
+        sink = sink + static_cast<std::size_t>(rect.w);
+    };
+
+    std::cout << "relayout, " << windows << " windows\n";
+
+    bool toggle = false;
+    report(
+        "display resized, every window affected",
+        measure([&] {
+            toggle = !toggle;
+            layout.parent_bounds(
+                0,
+                toggle ? layout_t::rect_t{0, 0, 2560, 1440}
+                       : layout_t::rect_t{0, 0, 1920, 1080});
+            sink = sink + layout.update(apply);
+        }));
+
+    report(
+        "other display resized, none affected",
+        measure([&] {
+            toggle = !toggle;
+            layout.parent_bounds(
+                1,
+                toggle ? layout_t::rect_t{1920, 0, 1280, 1024}
+                       : layout_t::rect_t{1920, 0, 1024, 768});
+            sink = sink + layout.update(apply);
+        }));
+
+    report(
+        "one window constrained",
+        measure([&] {
+            toggle = !toggle;
+            layout.constrain(
+                windows / 2,
+                {length_t::centered(),
+                 length_t::centered(),
+                 length_t::fraction(toggle ? 0.5 : 0.6),
+                 length_t::fraction(0.5)});
+            sink = sink + layout.update(apply);
+        }));
+
+    report("idle frame", measure([&] { sink = sink + layout.update(apply); }));
+}
+
+// panels of labels and rectangles, like a large sketch would have them
+void
+fill_scene(sk::scene_t& scene, std::size_t elements)
+{
+    using sk::length_t;
+
+    constexpr std::size_t per_panel = {100};
+
+    auto panel = sk::scene_t::npos;
+    for (std::size_t i = 0; i < elements; ++i) {
+        if (i % per_panel == 0) {
+            panel = scene.add(
+                sk::element_kind_t::panel,
+                sk::scene_t::npos,
+                {length_t::fraction(0.01 * static_cast<double>(i % 97)),
+                 length_t::fraction(0.01 * static_cast<double>(i % 89)),
+                 length_t::fraction(0.25),
+                 length_t::fraction(0.25)});
+            continue;
+        }
+
+        const bool label = (i % 2 != 0);
+        scene.add(
+            label ? sk::element_kind_t::label : sk::element_kind_t::rect,
+            panel,
+            {label ? length_t::centered() : length_t::pixels(i % 64),
+             length_t::fraction(0.01 * static_cast<double>(i % per_panel)),
+             length_t::fraction(0.5),
+             length_t::pixels(12)},
+            label ? "label" : "");
+    }
+}
+
+void
+bench_scene()
+{
+    constexpr std::size_t elements = {100'000};
+
+    std::cout << "scene, " << elements << " elements\n";
+
+    report(
+        "build",
+        measure(
+            [] {
+                sk::scene_t scene;
+                fill_scene(scene, elements);
+                sink = sink + scene.size();
+            },
+            500ms) /
+            elements,
+        "element");
+
+    sk::scene_t scene;
+    fill_scene(scene, elements);
+
+    bool toggle = false;
+    report(
+        "layout after a window resize",
+        measure([&] {
+            toggle = !toggle;
+            scene.resize(toggle ? 1920 : 1280, toggle ? 1080 : 720);
+            scene.layout();
+            sink = sink + static_cast<std::size_t>(scene.w().back());
+        }) / elements,
+        "element");
+
+    report("layout, nothing changed", measure([&] { scene.layout(); }));
+}
+
+// index build and queries of a laid out scene, against a linear scan
+void
+measure_hit_test(sk::scene_t& scene, int width, int height)
+{
+    scene.resize(width, height);
+    scene.layout();
+
+    sk::impl::hit_index_t index;
+    report(
+        "index build",
+        measure(
+            [&] {
+                index.build(
+                    scene.x(), scene.y(), scene.w(), scene.h(), width, height);
+            },
+            500ms));
+    std::cout << "  " << index.entries() << " grid entries\n";
+
+    // a mouse wandering over the whole window
+    std::vector<std::pair<int, int>> points(4096);
+    std::mt19937                     random(42);
+    for (auto& [x, y] : points) {
+        x = std::uniform_int_distribution<int>(0, width - 1)(random);
+        y = std::uniform_int_distribution<int>(0, height - 1)(random);
+    }
+
+    std::size_t next = 0;
+    report(
+        "motion event",
+        measure([&] {
+            const auto& [x, y] = points[next++ % points.size()];
+            sink               = sink + scene.hit_test(x, y);
+        }),
+        "query");
+
+    // what applications had to do by hand before
+    const auto xs = scene.x();
+    const auto ys = scene.y();
+    const auto ws = scene.w();
+    const auto hs = scene.h();
+    report(
+        "linear scan, for comparison",
+        measure([&] {
+            const auto& [x, y] = points[next++ % points.size()];
+            auto found         = sk::scene_t::npos;
+            for (auto i = xs.size(); i > 0; --i) {
+                if (xs[i - 1] <= x && x < xs[i - 1] + ws[i - 1] &&
+                    ys[i - 1] <= y && y < ys[i - 1] + hs[i - 1]) {
+                    found = static_cast<sk::element_id_t>(i - 1);
+                    break;
+                }
+            }
+            sink = sink + found;
+        }),
+        "query");
+}
+
+/* small rectangles spread over the window, then large ones piled on top of
+ * each other, each covering a quarter of it
+ */
+void
+bench_hit_test()
+{
+    using sk::length_t;
+
+    constexpr std::size_t elements = {100'000};
+    constexpr int         width    = {1920};
+    constexpr int         height   = {1080};
+
+    std::cout << "hit test, " << elements << " elements, "
+              << sk::impl::hit_index_t::isa() << '\n';
+
+    {
+        sk::scene_t scene;
+        fill_scene(scene, elements);
+        measure_hit_test(scene, width, height);
+    }
+
+    std::cout << "hit test, " << elements << " overlapping large elements\n";
+
+    sk::scene_t  scene;
+    std::mt19937 random(7);
+    for (std::size_t i = 0; i < elements; ++i) {
+        scene.add(
+            sk::element_kind_t::rect,
+            sk::scene_t::npos,
+            {length_t::fraction(
+                 std::uniform_real_distribution<double>(0.0, 0.5)(random)),
+             length_t::fraction(
+                 std::uniform_real_distribution<double>(0.0, 0.5)(random)),
+             length_t::fraction(0.5),
+             length_t::fraction(0.5)});
+    }
+    measure_hit_test(scene, width, height);
+}
+
+void
+bench_raster()
+{
+    constexpr std::size_t width  = {1920};
+    constexpr std::size_t height = {1080};
+    constexpr double      pixels = {static_cast<double>(width * height)};
+
+    // a full frame, row by row as the canvas draws it
+    std::vector<std::uint32_t> frame(width * height, 0xff202020u);
+    std::vector<std::uint32_t> image(width * height, 0xff3070c0u);
+    const auto rows = [&](auto&& row) {
+        for (std::size_t y = 0; y < height; ++y) {
+            row(frame.data() + y * width, image.data() + y * width);
+        }
+        sink = sink + frame[sink % frame.size()];
+    };
+    const auto megapixels = [](double ns) { return pixels / ns * 1'000.0; };
+
+    std::cout << "raster, " << width << "x" << height << " frame\n";
+    for (const auto& kernels : sk::impl::supported_raster_kernels()) {
+        const auto fill = measure([&] {
+            rows([&](std::uint32_t* dst, const std::uint32_t*) {
+                kernels.fill(dst, width, 0xff808080u);
+            });
+        });
+        const auto blend = measure([&] {
+            rows([&](std::uint32_t* dst, const std::uint32_t*) {
+                kernels.blend(dst, width, 0xff808080u, 96);
+            });
+        });
+        const auto copy = measure([&] {
+            rows([&](std::uint32_t* dst, const std::uint32_t* src) {
+                kernels.copy(dst, src, width);
+            });
+        });
+
+        std::cout << "  " << std::left << std::setw(8) << kernels.isa
+                  << std::right << std::fixed << std::setprecision(0)
+                  << "fill " << std::setw(6) << megapixels(fill)
+                  << "  blend " << std::setw(6) << megapixels(blend)
+                  << "  blit " << std::setw(6) << megapixels(copy)
+                  << " Mpx/s\n";
+    }
+}
+
+/* chord lookups of a key press as the number of bindings grows, it should
+ * stay flat; presses are random, most of them find nothing bound
+ */
+void
+bench_keys()
+{
+    using table_t = sk::impl::chord_table_t;
+
+    std::mt19937                       random(7);
+    std::uniform_int_distribution<int> modifiers(0, 15);
+    std::uniform_int_distribution<int> scancodes(4, 231); // SDL's usual keys
+    const auto                         chord = [&] {
+        return sk::chord_t{static_cast<sk::modifiers_t>(modifiers(random)),
+                           static_cast<sk::scancode_t>(scancodes(random))};
+    };
+
+    std::vector<sk::chord_t> presses(4096);
+    std::generate(presses.begin(), presses.end(), chord);
+
+    std::cout << "keys\n";
+    for (const std::size_t bindings : {16, 1024, 16384}) {
+        std::vector<table_t::entry_t> entries(bindings);
+        for (std::uint32_t i = 0; i < bindings; ++i) {
+            entries[i] = {chord(), i};
+        }
+
+        table_t    table;
+        const auto built = measure([&] { table.build(entries); }, 100ms);
+
+        std::size_t at = 0;
+        const auto  ns = measure([&] {
+            const auto found = table.find(presses[at++ % presses.size()]);
+            sink             = sink + found.size();
+        });
+
+        std::ostringstream what;
+        what << bindings << " bindings";
+        report(what.str() + ", build", built, "build");
+        report(what.str() + ", press", ns, "press");
+    }
+}
+
+// a window with panels of nested elements and comments, as sketches have them
+std::string
+make_sketch(std::size_t panels)
+{
+    std::ostringstream result;
+    result << "// generated\n"
+              "window = 'bench':\n"
+              "    width = 50%\n"
+              "    height = 50%\n"
+              "    position = 10px, 20%\n";
+    for (std::size_t i = 0; i < panels; ++i) {
+        result << "    /* panel " << i << " */\n"
+               << "    panel = 'panel " << i << "' {\n"
+               << "        width = 25%\n"
+                  "        height = 120px\n"
+                  "        label = \"caption\" {\n"
+                  "            centered\n"
+                  "        }\n"
+                  "        rect {\n"
+                  "            width = 90%\n"
+                  "            height = 1px\n"
+                  "            position = centered, 50%\n"
+                  "        }\n"
+                  "    }\n";
+    }
+    return result.str();
+}
+
+void
+bench_parse()
+{
+    const auto input = make_sketch(10'000);
+    const auto bytes = static_cast<double>(input.size());
+
+    std::cout << "parse, " << input.size() << " bytes\n";
+
+    std::ostringstream diagnostics;
+    const auto         ns = measure(
+        [&] {
+            const auto ast = sk::impl::parse_sketch(input, diagnostics);
+            sink           = sink + ast.window->get_children().size();
+        },
+        2s);
+    report("whole sketch", ns / bytes, "byte");
+}
+
+// what a corpus input costs to parse, as it grows
+struct growth_t {
+    std::size_t bytes;           // of the largest size
+    double      ns_per_byte;     // at the largest size
+    double      allocs_per_byte; // at the largest size
+    double      time_exponent;   // 1 is linear
+    double      alloc_exponent;
+};
+
+/* parses the input at four sizes, each twice the previous one, and fits how
+ * time and allocations grow with the size; failing to parse is fine, errors
+ * are formatted but written nowhere
+ */
+growth_t
+measure_growth(const std::function<std::string(std::size_t)>& make)
+{
+    std::ostream diagnostics(nullptr);
+
+    constexpr std::size_t sizes = {4};
+    double                bytes[sizes];
+    double                ns[sizes];
+    double                allocs[sizes];
+    for (std::size_t i = 0; i < sizes; ++i) {
+        const auto input = make(std::size_t{1} << i);
+        const auto parse = [&] {
+            try {
+                const auto ast = sk::impl::parse_sketch(input, diagnostics);
+                sink           = sink + ast.definitions.size();
+            } catch (const std::runtime_error&) {
+                sink = sink + 1;
+            }
+        };
+
+        const auto before = allocations;
+        parse();
+        allocs[i] = static_cast<double>(allocations - before);
+        bytes[i]  = static_cast<double>(input.size());
+        ns[i]     = measure(parse, 100ms);
+    }
+
+    // small allocation counts don't tell much, a few more aren't growth
+    const auto exponent = [&](const double* values, double floor) {
+        return std::log(std::max(values[sizes - 1], floor) /
+                        std::max(values[0], floor)) /
+               std::log(bytes[sizes - 1] / bytes[0]);
+    };
+    return {static_cast<std::size_t>(bytes[sizes - 1]),
+            ns[sizes - 1] / bytes[sizes - 1],
+            allocs[sizes - 1] / bytes[sizes - 1],
+            exponent(ns, 1.0),
+            exponent(allocs, 16.0)};
+}
+
+// set by benchmarks that found a regression, the run then fails
+bool regressed = {false};
+
+/* parse time per byte of every input of the corpus, grown by repeating the
+ * input, and of generated worst cases; a sketch describes one window, so
+ * whatever follows the first window isn't parsed, but what comes before it,
+ * definitions, includes, comments and broken input, is
+ */
+void
+bench_corpus()
+{
+    namespace fs = std::experimental::filesystem;
+
+    // noise makes small inputs look superlinear, so they're a few kB at least
+    constexpr double      max_time_exponent   = {1.3};
+    constexpr double      max_alloc_exponent  = {1.15};
+    constexpr double      max_allocs_per_byte = {0.5};
+    constexpr std::size_t min_bytes           = {4096};
+
+    std::vector<std::pair<std::string, std::function<std::string(std::size_t)>>>
+        inputs;
+
+    const auto* corpus = std::getenv("SKETCH_CORPUS");
+    const auto  directory = fs::path(corpus ? corpus : SKETCH_CORPUS_DIR);
+    if (fs::is_directory(directory)) {
+        for (const auto& entry : fs::directory_iterator(directory)) {
+            std::ifstream file(entry.path(), std::ios::binary);
+            std::string   input{std::istreambuf_iterator<char>(file),
+                              std::istreambuf_iterator<char>()};
+            if (input.empty()) {
+                continue;
+            }
+
+            const auto times = (min_bytes + input.size() - 1) / input.size();
+            inputs.emplace_back(
+                entry.path().filename().string(), [=](std::size_t scale) {
+                    std::string result;
+                    for (std::size_t i = 0; i < times * scale; ++i) {
+                        result += input;
+                    }
+                    return result;
+                });
+        }
+        std::sort(
+            inputs.begin(), inputs.end(), [](const auto& a, const auto& b) {
+                return a.first < b.first;
+            });
+    }
+
+    const auto repeat = [](std::string_view prefix,
+                           std::string_view body,
+                           std::string_view suffix,
+                           std::size_t      times) {
+        std::string result(prefix);
+        for (std::size_t i = 0; i < times; ++i) {
+            result += body;
+        }
+        return result += suffix;
+    };
+    inputs.emplace_back("(generated sketch)", [](std::size_t scale) {
+        return make_sketch(100 * scale);
+    });
+    inputs.emplace_back("(long expression)", [=](std::size_t scale) {
+        return repeat(
+            "let a = ", "1px + 2 * (3% - b) / 4 - ", "c\n", 400 * scale);
+    });
+    inputs.emplace_back("(unary minus chain)", [=](std::size_t scale) {
+        return repeat("let a = ", "-", "1px\n", 2000 * scale);
+    });
+    inputs.emplace_back("(nested parentheses)", [=](std::size_t scale) {
+        return repeat("let a = ", "(", "1px", 32 * scale) +
+               std::string(32 * scale, ')');
+    });
+    inputs.emplace_back("(unterminated comment)", [=](std::size_t scale) {
+        return repeat("let a = 1px /*", "* / /", "", 1000 * scale);
+    });
+    inputs.emplace_back("(unterminated string)", [=](std::size_t scale) {
+        return repeat("window = '", "a\"b", "", 2000 * scale);
+    });
+    inputs.emplace_back("(comments)", [=](std::size_t scale) {
+        return repeat("", "/* a */ // b\n", "window = 'x':\n", 500 * scale);
+    });
+
+    std::cout << "corpus, " << directory.string() << '\n'
+              << "  " << std::left << std::setw(28) << "input" << std::right
+              << std::setw(8) << "bytes" << std::setw(10) << "ns/byte"
+              << std::setw(13) << "allocs/byte" << std::setw(7) << "time"
+              << std::setw(8) << "allocs" << "  (growth exponents)\n";
+    for (const auto& [name, make] : inputs) {
+        const auto growth = measure_growth(make);
+
+        std::string verdict;
+        if (growth.time_exponent > max_time_exponent) {
+            verdict += "  superlinear time";
+        }
+        if (growth.alloc_exponent > max_alloc_exponent ||
+            growth.allocs_per_byte > max_allocs_per_byte) {
+            verdict += "  excessive allocations";
+        }
+        regressed = regressed || !verdict.empty();
+
+        std::cout << "  " << std::left << std::setw(28) << name.substr(0, 27)
+                  << std::right << std::setw(8) << growth.bytes << std::fixed
+                  << std::setprecision(1) << std::setw(10)
+                  << growth.ns_per_byte << std::setprecision(3)
+                  << std::setw(13) << growth.allocs_per_byte
+                  << std::setprecision(2) << std::setw(7)
+                  << growth.time_exponent << std::setw(8)
+                  << growth.alloc_exponent << verdict << '\n';
+    }
+}
+
+/* runs the child in that many forked processes at once, and the parent
+ * meanwhile; returns nanoseconds until the last child exited, a child that
+ * fails fails the run
+ */
+template <typename ChildType, typename ParentType>
+double
+run_processes(std::size_t count, ChildType&& child, ParentType&& parent)
+{
+    std::cout.flush();
+    const auto         started = bench_clock_t::now();
+    std::vector<pid_t> children;
+    for (std::size_t i = 0; i < count; ++i) {
+        const auto pid = fork();
+        if (pid < 0) {
+            throw std::system_error(errno, std::generic_category(), "fork");
+        }
+        if (!pid) {
+            auto status = EXIT_FAILURE;
+            try {
+                status = child() ? EXIT_SUCCESS : EXIT_FAILURE;
+            } catch (const std::exception& e) {
+                std::cerr << e.what() << '\n';
+            }
+            std::_Exit(status);
+        }
+        children.push_back(pid);
+    }
+
+    parent();
+    bool succeeded = true;
+    for (const auto pid : children) {
+        int status = 0;
+        waitpid(pid, &status, 0);
+        succeeded = succeeded && WIFEXITED(status) && !WEXITSTATUS(status);
+    }
+    if (!succeeded) {
+        std::cout << "  a process failed\n";
+        regressed = true;
+    }
+
+    return std::chrono::duration<double, std::nano>(
+               bench_clock_t::now() - started)
+        .count();
+}
+
+// windows whose titles and texts are all the same, to tell torn reads apart
+std::vector<sk::impl::window_spec_t>
+make_wall(const std::string& text, std::size_t windows, std::size_t elements)
+{
+    const sk::geometry_t geometry = {sk::length_t::centered(),
+                                     sk::length_t::centered(),
+                                     sk::length_t::fraction(0.5, -20),
+                                     sk::length_t::fraction(0.5)};
+
+    std::vector<sk::impl::window_spec_t> result(windows);
+    for (auto& window : result) {
+        window.title    = text;
+        window.geometry = geometry;
+        window.elements.assign(
+            elements,
+            {sk::element_kind_t::rect, sk::scene_t::npos, geometry, text});
+    }
+    return result;
+}
+
+/* startup of a multi-process window wall, every process parsing the same
+ * sketch against one of them publishing it to a layout segment and the
+ * others mapping it; then readers racing a publisher
+ */
+void
+bench_wall()
+{
+    namespace fs = std::experimental::filesystem;
+    using segment_t = sk::impl::layout_segment_t;
+
+    constexpr std::size_t processes = {8};
+    constexpr auto        race      = std::chrono::milliseconds(300ms);
+
+    const auto path = fs::temp_directory_path() /
+                      ("sketch_bench_" + std::to_string(getpid()) + ".sketch");
+    std::ofstream(path) << make_sketch(2'000);
+    const std::vector<std::string> sketches = {path.string()};
+    const auto name = "/sketch_bench_" + std::to_string(getpid());
+
+    std::cout << "wall, " << processes << " processes\n";
+
+    std::ostream diagnostics(nullptr);
+    const auto   elements =
+        sk::impl::load_window_specs(sketches, diagnostics)[0].elements.size();
+    report(
+        "every process parses",
+        run_processes(
+            processes,
+            [&] {
+                const auto specs =
+                    sk::impl::load_window_specs(sketches, diagnostics);
+                return specs[0].elements.size() == elements;
+            },
+            [] {}),
+        "startup");
+
+    {
+        const auto started = bench_clock_t::now();
+        segment_t  segment(name, segment_t::access_t::publish);
+        segment.publish(sk::impl::load_window_specs(sketches, diagnostics));
+        const auto published = std::chrono::duration<double, std::nano>(
+                                   bench_clock_t::now() - started)
+                                   .count();
+        report(
+            "one parses and publishes, the others map",
+            published + run_processes(
+                            processes,
+                            [&] {
+                                segment_t follower(
+                                    name, segment_t::access_t::follow);
+                                const auto read = follower.read();
+                                return read && read->first.size() == 1 &&
+                                       read->first[0].elements.size() ==
+                                           elements;
+                            },
+                            [] {}),
+            "startup");
+    }
+    fs::remove(path);
+
+    // every read is all of one wall or all of the other, never a mix
+    const auto walls = {make_wall("a", 3, 2'000), make_wall("b", 5, 3'000)};
+    const auto whole = [&walls](const auto& specs) {
+        return std::any_of(walls.begin(), walls.end(), [&](const auto& wall) {
+            return std::equal(
+                wall.begin(),
+                wall.end(),
+                specs.begin(),
+                specs.end(),
+                [](const auto& a, const auto& b) {
+                    return a.title == b.title &&
+                           a.elements.size() == b.elements.size() &&
+                           std::all_of(
+                               b.elements.begin(),
+                               b.elements.end(),
+                               [&a](const auto& element) {
+                                   return element.text == a.title;
+                               });
+                });
+        });
+    };
+
+    segment_t segment(name, segment_t::access_t::publish);
+    segment.publish(*walls.begin());
+    const auto  deadline  = bench_clock_t::now() + race;
+    std::size_t publishes = 0;
+    run_processes(
+        processes,
+        [&] {
+            segment_t follower(name, segment_t::access_t::follow);
+            while (bench_clock_t::now() < deadline) {
+                const auto read = follower.read();
+                if (read && !whole(read->first)) {
+                    std::cerr << "torn read of generation " << read->second
+                              << '\n';
+                    return false;
+                }
+            }
+            return true;
+        },
+        [&] {
+            while (bench_clock_t::now() < deadline) {
+                segment.publish(walls.begin()[++publishes % 2]);
+            }
+        });
+    std::cout << "  " << publishes << " publishes raced by " << processes
+              << " readers\n";
+}
+
+/* what introspection costs the application loop per frame of a dozen events
+ * and a few windows drawn: alone, with a server and with a server streaming
+ * every frame to one client while another asks for snapshots in a loop,
+ * which should cost the loop nothing more
+ */
+void
+bench_introspect()
+{
+    using metrics_t = sk::impl::metrics_t;
+
+    constexpr std::uint32_t windows = {64};
+
+    metrics_t metrics;
+    for (std::uint32_t i = 0; i < windows; ++i) {
+        metrics.attach(i, 0, "window " + std::to_string(i));
+        metrics.place(i, 0, 0, 640, 480);
+    }
+
+    std::uint32_t at    = 0;
+    const auto    frame = [&] {
+        metrics.begin_frame();
+        for (std::size_t i = 0; i < 12; ++i) {
+            metrics.event(at++ % windows);
+        }
+        for (std::size_t i = 0; i < 4; ++i) {
+            metrics.drawn(at++ % windows);
+        }
+        metrics.end_frame({});
+    };
+
+    std::cout << "introspect\n";
+    report("no server", measure(frame), "frame");
+
+    const auto path =
+        "/tmp/sketch_bench." + std::to_string(getpid()) + ".socket";
+    sk::impl::introspection_server_t server(path, metrics);
+    report("server, no client", measure(frame), "frame");
+
+    const auto connect_client = [&path](std::string_view command) {
+        sockaddr_un address = {};
+        address.sun_family  = AF_UNIX;
+        path.copy(address.sun_path, sizeof(address.sun_path) - 1);
+
+        const auto fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0 ||
+            connect(
+                fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) <
+                0 ||
+            write(fd, command.data(), command.size()) < 0) {
+            throw std::system_error(errno, std::generic_category(), path);
+        }
+        return fd;
+    };
+
+    // both read whatever comes, the snapshot client asks again once it has
+    std::atomic<bool>        stop      = {false};
+    std::atomic<std::size_t> snapshots = {0};
+    std::atomic<std::size_t> streamed  = {0};
+    const auto               streaming = connect_client("stream\n");
+    const auto               asking    = connect_client("snapshot\n");
+    std::thread              stream_reader([&] {
+        char buffer[4096];
+        for (ssize_t got; !stop && (got = read(streaming, buffer, 4096)) > 0;) {
+            streamed += static_cast<std::size_t>(
+                std::count(buffer, buffer + got, '\n'));
+        }
+    });
+    std::thread snapshot_reader([&] {
+        char buffer[4096];
+        for (ssize_t got; !stop && (got = read(asking, buffer, 4096)) > 0;) {
+            if (buffer[got - 1] == '\n') {
+                ++snapshots;
+                sink = sink + static_cast<std::size_t>(
+                                  write(asking, "snapshot\n", 9));
+            }
+        }
+    });
+
+    report("server, streaming and snapshot clients", measure(frame), "frame");
+
+    stop = true;
+    shutdown(streaming, SHUT_RDWR);
+    shutdown(asking, SHUT_RDWR);
+    stream_reader.join();
+    snapshot_reader.join();
+    close(streaming);
+    close(asking);
+    std::cout << "  " << streamed << " frames streamed, " << snapshots
+              << " snapshots served\n";
+}
+
+/* what a worker does with a 1080p window capture, per capture; the read back
+ * on the main thread is a row copy, see raster
+ */
+void
+bench_capture()
+{
+    constexpr int width  = {1920};
+    constexpr int height = {1080};
+
+    std::vector<std::uint8_t> pixels(std::size_t{width} * height * 4);
+    std::mt19937              random(11);
+    std::generate(pixels.begin(), pixels.end(), [&random] {
+        return static_cast<std::uint8_t>(random());
+    });
+
+    std::cout << "capture\n";
+    report(
+        "1080p to rgba",
+        measure([&] { sk::impl::to_rgba(pixels, {}); }, 100ms),
+        "capture");
+    report(
+        "1080p crc32",
+        measure([&] { sink = sink + sk::impl::crc32(pixels); }, 100ms),
+        "capture");
+    report(
+        "1080p adler32",
+        measure([&] { sink = sink + sk::impl::adler32(pixels); }, 100ms),
+        "capture");
+    report(
+        "1080p png",
+        measure(
+            [&] {
+                const auto png = sk::impl::encode_png(pixels, width, height);
+                sink           = sink + png.size();
+            },
+            100ms),
+        "capture");
+}
+
+/* records events with known pauses between them and replays the log, the
+ * deadlines the player reads back have to be as far apart as the pauses, give
+ * or take the scheduler; then what reading a long log back costs per event
+ */
+void
+bench_replay()
+{
+    namespace fs = std::experimental::filesystem;
+    using player_t = sk::impl::event_player_t;
+
+    constexpr std::chrono::microseconds pauses[] = {
+        1ms, 3ms, 10ms, 20ms, 2ms, 40ms};
+    constexpr auto slack = std::chrono::milliseconds(30ms);
+
+    const auto path = (fs::temp_directory_path() /
+                       ("sketch_bench_" + std::to_string(getpid()) + ".skev"))
+                          .string();
+
+    // motion of a window that doesn't exist on replay, so none is pushed
+    SDL_Event event = {};
+    event.type      = SDL_MOUSEMOTION;
+    event.motion.x  = 1;
+
+    {
+        sk::impl::event_recorder_t recorder(path);
+        for (const auto pause : pauses) {
+            std::this_thread::sleep_for(pause);
+            recorder.record(event, 0);
+        }
+    }
+
+    std::cout << "replay\n";
+
+    const auto no_window = [](std::size_t) { return std::uint32_t{0}; };
+    player_t   player(path, 1.0);
+    auto       deadline = player.next_deadline();
+    double     error_us = 0.0;
+    for (std::size_t i = 1; i < std::size(pauses); ++i) {
+        player.inject(deadline, no_window);
+        const auto next  = player.next_deadline();
+        const auto delay = next - deadline;
+        if (delay < pauses[i] || delay > pauses[i] + slack) {
+            std::cerr << "  delay " << i << " recorded after "
+                      << pauses[i].count() << " us replays after "
+                      << std::chrono::duration_cast<std::chrono::microseconds>(
+                             delay)
+                             .count()
+                      << " us\n";
+            regressed = true;
+        }
+        error_us += std::chrono::duration<double, std::micro>(
+                        delay - pauses[i])
+                        .count();
+        deadline = next;
+    }
+    player.inject(deadline, no_window);
+    if (!player.finished()) {
+        std::cerr << "  events left after the last recorded one\n";
+        regressed = true;
+    }
+    std::cout << "  " << std::size(pauses) - 1 << " delays replayed, "
+              << std::fixed << std::setprecision(1)
+              << error_us / static_cast<double>(std::size(pauses) - 1)
+              << " us late on average\n";
+
+    {
+        sk::impl::event_recorder_t recorder(path);
+        for (std::size_t i = 0; i < 100'000; ++i) {
+            recorder.record(event, 0);
+        }
+    }
+    report(
+        "100k recorded events read back",
+        measure(
+            [&] {
+                player_t replay(path, 1.0);
+                replay.inject(player_t::clock_t::time_point::max(), no_window);
+                sink = sink + replay.finished();
+            },
+            100ms),
+        "log");
+
+    fs::remove(path);
+}
+
+constexpr std::pair<std::string_view, void (*)()> benchmarks[] = {
+    {"relayout", bench_relayout},
+    {"scene", bench_scene},
+    {"hit_test", bench_hit_test},
+    {"raster", bench_raster},
+    {"keys", bench_keys},
+    {"parse", bench_parse},
+    {"corpus", bench_corpus},
+    {"wall", bench_wall},
+    {"introspect", bench_introspect},
+    {"capture", bench_capture},
+    {"replay", bench_replay}};
+}
+
+int
+main(int argc, char** argv)
+{
+    for (const auto& [name, run] : benchmarks) {
+        bool selected = (argc < 2);
+        for (int i = 1; i < argc; ++i) {
+            selected = selected || (name == argv[i]);
+        }
+
+        if (selected) {
+            run();
+        }
+    }
+
+    return regressed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
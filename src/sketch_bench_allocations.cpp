@@ -0,0 +1,31 @@
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+/* counts every allocation of sketch_bench, the library's included; kept out
+ * of the benchmarks and never inlined, or gcc sees malloc behind operator new
+ * and takes every delete of theirs for a mismatched one
+ */
+std::size_t allocations = {0};
+
+[[gnu::noinline]] void*
+operator new(std::size_t size)
+{
+    ++allocations;
+    if (auto* result = std::malloc(size ? size : 1)) {
+        return result;
+    }
+    throw std::bad_alloc();
+}
+
+[[gnu::noinline]] void
+operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+[[gnu::noinline]] void
+operator delete(void* ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
@@ -0,0 +1,32 @@
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <stdexcept>
+#include <string_view>
+
+#include "parser.hpp"
+
+/* libFuzzer target of the parse stage of load_sketch, configure with clang
+ * and -DSKETCH_FUZZ=ON, then run the fuzz target or, by hand:
+ *
+ *     sketch_fuzz -dict=fuzz/sketch.dict -timeout=2 corpus fuzz/corpus
+ *
+ * inputs that don't parse are fine, crashes, sanitizer reports and timeouts
+ * aren't; inputs found this way are worth adding to fuzz/corpus, which the
+ * corpus benchmark of sketch_bench checks for superlinear parse times
+ */
+
+extern "C" int
+LLVMFuzzerTestOneInput(const std::uint8_t* data, std::size_t size)
+{
+    // diagnostics are formatted, but written nowhere
+    static std::ostream diagnostics(nullptr);
+
+    // exactly the bytes given, so that reads past the input get reported
+    const std::string_view input(reinterpret_cast<const char*>(data), size);
+    try {
+        sk::impl::parse_sketch(input, diagnostics, "fuzz");
+    } catch (const std::runtime_error&) {
+    }
+    return 0;
+}
@@ -0,0 +1,181 @@
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include <SDL.h>
+
+#include <sketch.hpp>
+
+/* headless test of the job system as reactor callbacks use it: synthetic key
+ * presses and mouse moves are pushed into the SDL queue, every callback
+ * spawns a job and the continuations have to come back to the main thread,
+ * each with its job's result; a window closed while its jobs run gets none
+ * of their continuations
+ *
+ * runs with SDL_VIDEODRIVER=dummy unless another driver is asked for
+ */
+
+using namespace std::chrono_literals;
+
+namespace {
+
+constexpr std::size_t keys  = {200};
+constexpr std::size_t moves = {200};
+
+std::uint64_t
+sum_to(std::size_t n)
+{
+    std::vector<std::uint64_t> values(n * 100 + 1);
+    std::iota(values.begin(), values.end(), std::uint64_t{0});
+    return std::accumulate(values.begin(), values.end(), std::uint64_t{0});
+}
+
+std::uint64_t
+expected(std::size_t n)
+{
+    const auto last = static_cast<std::uint64_t>(n) * 100;
+    return last * (last + 1) / 2;
+}
+
+void
+push(SDL_Event& event)
+{
+    if (SDL_PushEvent(&event) < 0) {
+        throw std::runtime_error(SDL_GetError());
+    }
+}
+}
+
+int
+main()
+{
+    setenv("SDL_VIDEODRIVER", "dummy", 0);
+
+    const auto main_thread = std::this_thread::get_id();
+    std::vector<std::string> failures;
+    const auto check = [&failures](bool passed, std::string_view what) {
+        if (!passed) {
+            failures.emplace_back(what);
+        }
+    };
+
+    sk::application_t        app;
+    std::size_t              finished  = 0;
+    std::size_t              off_main  = 0; // jobs that ran on a worker
+    std::atomic<std::size_t> slept     = {0}; // jobs of the closed window
+    std::size_t              orphaned  = 0; // and their continuations
+    bool                     timed_out = false;
+
+    const auto job = [main_thread](std::size_t n) {
+        return [main_thread, n] {
+            // counted on the main thread, by the continuation
+            const bool worker = (std::this_thread::get_id() != main_thread);
+            return std::tuple{n, sum_to(n), worker};
+        };
+    };
+    const auto then = [&, main_thread](
+                          gsl::not_null<sk::window_t*>,
+                          std::tuple<std::size_t, std::uint64_t, bool>&&
+                              result) {
+        const auto& [n, sum, worker] = result;
+        check(
+            std::this_thread::get_id() == main_thread,
+            "continuation off the main thread");
+        check(sum == expected(n), "wrong result for " + std::to_string(n));
+        off_main += worker;
+        ++finished;
+    };
+
+    sk::window_t window("jobs", std::tuple{0u, 0u, 320u, 240u});
+    window.reactor().set_on_keydown(
+        [&](gsl::not_null<sk::window_t*> w, std::size_t key) {
+            w->spawn(job(key), then);
+        });
+    window.reactor().set_on_mouse_move(
+        [&](gsl::not_null<sk::window_t*> w,
+            const std::tuple<std::size_t, std::size_t>& point) {
+            w->spawn(job(std::get<0>(point)), then);
+        });
+
+    // spawns slow jobs, then closes itself right away
+    constexpr std::size_t closing_jobs = {16};
+
+    sk::window_t closing("closing", std::tuple{320u, 0u, 320u, 240u});
+    closing.reactor().set_on_keydown(
+        [&](gsl::not_null<sk::window_t*> w, std::size_t) {
+            for (std::size_t i = 0; i < closing_jobs; ++i) {
+                w->spawn(
+                    [&slept] {
+                        std::this_thread::sleep_for(5ms);
+                        ++slept;
+                    },
+                    [&orphaned](gsl::not_null<sk::window_t*>) { ++orphaned; });
+            }
+            w->close();
+        });
+
+    const auto handle         = app.add(std::move(window));
+    const auto closing_handle = app.add(std::move(closing));
+    const auto id             = SDL_GetWindowID(*app.get(handle));
+
+    SDL_Event event    = {};
+    event.type         = SDL_KEYDOWN;
+    event.key.state    = SDL_PRESSED;
+    event.key.windowID = SDL_GetWindowID(*app.get(closing_handle));
+    push(event);
+
+    event.key.windowID = id;
+    for (std::size_t i = 0; i < keys; ++i) {
+        event.key.keysym.sym = static_cast<SDL_Keycode>('a' + i % 26);
+        push(event);
+    }
+
+    event                 = {};
+    event.type            = SDL_MOUSEMOTION;
+    event.motion.windowID = id;
+    for (std::size_t i = 0; i < moves; ++i) {
+        event.motion.x = static_cast<Sint32>(i);
+        event.motion.y = static_cast<Sint32>(i);
+        push(event);
+    }
+
+    /* done once everything came back, and once the loop drained what the
+     * closed window's last jobs posted, a tick later
+     */
+    app.get(handle)->schedule_every(
+        10ms, [&, settled = false](gsl::not_null<sk::window_t*>) mutable {
+            if (finished == keys + moves && slept == closing_jobs) {
+                if (settled) {
+                    app.quit();
+                }
+                settled = true;
+            }
+        });
+    app.get(handle)->schedule_after(
+        10s, [&app, &timed_out](gsl::not_null<sk::window_t*>) {
+            timed_out = true;
+            app.quit();
+        });
+
+    app.run();
+
+    check(!timed_out, "timed out with " + std::to_string(finished) + " of " +
+                          std::to_string(keys + moves) + " continuations");
+    check(off_main == finished, "jobs ran on the main thread");
+    check(orphaned == 0, "continuations ran for a closed window");
+
+    for (const auto& failure : failures) {
+        std::cerr << "failed: " << failure << '\n';
+    }
+    return failures.empty() ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,269 @@
+#include "sketch_loader.hpp"
+
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <system_error>
+
+#include "parser.hpp"
+
+namespace sk::impl {
+
+namespace fs = std::experimental::filesystem;
+
+namespace {
+
+using value_t  = sketch_loader_t::value_t;
+using module_t = sketch_loader_t::module_t;
+
+// utf-8 is kept as is, titles and labels are utf-8 strings anyway
+std::string
+read_file(const std::string& filename)
+{
+    std::ifstream file(filename, std::ios::binary);
+    if (!file) {
+        throw std::runtime_error("failed to open file");
+    }
+    return {std::istreambuf_iterator<char>(file),
+            (std::istreambuf_iterator<char>())};
+}
+
+[[noreturn]] void
+fail(const module_t& module, const char* where, const std::string& message)
+{
+    module.errors(where, "error! " + message + " here: ");
+    throw std::runtime_error("evaluation error");
+}
+}
+
+sketch_loader_t::module_t::module_t(
+    std::string canonical, std::string text, std::ostream& out)
+    : path(std::move(canonical)),
+      source(std::move(text)),
+      errors(source, out, path)
+{
+}
+
+sketch_loader_t::sketch_loader_t(std::ostream& diagnostics)
+    : _diagnostics(diagnostics)
+{
+}
+
+sketch_loader_t::~sketch_loader_t() = default;
+
+module_t&
+sketch_loader_t::load(const fs::path& path, module_t* from, const char* where)
+{
+    std::error_code error;
+    const auto      canonical = fs::canonical(path, error).string();
+    if (error && !from) {
+        throw std::runtime_error("no such file");
+    } else if (error) {
+        fail(*from, where, "can't open " + path.string());
+    }
+
+    if (const auto found = _modules.find(canonical); found != _modules.end()) {
+        if (found->second->loading) {
+            fail(*from, where, canonical + " includes itself");
+        }
+        return *found->second;
+    }
+
+    auto& module = *_modules
+                        .emplace(
+                            canonical,
+                            std::make_unique<module_t>(
+                                canonical, read_file(canonical), _diagnostics))
+                        .first->second;
+    try {
+        module.ast = parse_sketch(module.source, _diagnostics, module.path);
+
+        const auto& definitions = module.ast.definitions;
+        for (std::size_t i = 0; i < definitions.size(); ++i) {
+            if (!module.names.emplace(definitions[i].name, i).second) {
+                fail(
+                    module,
+                    definitions[i].where,
+                    definitions[i].name + " is already defined");
+            }
+        }
+        module.memos.resize(definitions.size());
+
+        // relative to the including file, not to the working directory
+        const auto directory = fs::path(canonical).parent_path();
+        for (const auto& include : module.ast.includes) {
+            auto& included =
+                load(directory / include.path, &module, include.where);
+            if (included.ast.window) {
+                fail(
+                    module,
+                    include.where,
+                    "included files can only include and define constants");
+            }
+            module.includes.push_back(&included);
+        }
+    } catch (...) {
+        _modules.erase(canonical);
+        throw;
+    }
+
+    module.loading = false;
+    return module;
+}
+
+module_t&
+sketch_loader_t::load(std::string_view filename)
+{
+    if (filename.empty()) {
+        throw std::invalid_argument("filename is an empty string");
+    }
+
+    if (!fs::exists(fs::path(std::string(filename)))) {
+        throw std::runtime_error("no such file");
+    }
+
+    auto& module = load(fs::path(std::string(filename)), nullptr, nullptr);
+    if (!module.ast.window) {
+        fail(
+            module,
+            module.source.data() + module.source.size(),
+            "expecting: window");
+    }
+    return module;
+}
+
+// depth-first, the first include that defines the name wins
+std::optional<std::pair<module_t*, std::size_t>>
+sketch_loader_t::find(module_t& module, const std::string& name)
+{
+    if (const auto found = module.names.find(name);
+        found != module.names.end()) {
+        return std::pair{&module, found->second};
+    }
+
+    for (auto* included : module.includes) {
+        if (const auto found = find(*included, name)) {
+            return found;
+        }
+    }
+    return std::nullopt;
+}
+
+// constants are evaluated in the scope of the file defining them
+value_t
+sketch_loader_t::lookup(module_t& module, const expression_ast::node_t& node)
+{
+    const auto found = find(module, node.name);
+    if (!found) {
+        fail(module, node.where, node.name + " isn't defined");
+    }
+
+    auto& [owner, index] = *found;
+    auto& memo           = owner->memos[index];
+    switch (memo.state) {
+    case module_t::state_t::done: return memo.value;
+    case module_t::state_t::evaluating:
+        fail(module, node.where, node.name + " is defined by itself");
+    default: break;
+    }
+
+    memo.state = module_t::state_t::evaluating;
+    try {
+        memo.value = evaluate(*owner, owner->ast.definitions[index].value);
+    } catch (...) {
+        memo.state = module_t::state_t::unevaluated;
+        throw;
+    }
+    memo.state = module_t::state_t::done;
+    return memo.value;
+}
+
+value_t
+sketch_loader_t::evaluate(module_t& module, const expression_ast& expression)
+{
+    using op_t = expression_ast::op_t;
+
+    std::vector<value_t> stack;
+    for (const auto& node : expression.nodes) {
+        switch (node.op) {
+        case op_t::number: stack.push_back({false, 0, node.value}); continue;
+        case op_t::pixels: stack.push_back({true, 0, node.value}); continue;
+        case op_t::percent:
+            stack.push_back({true, node.value / 100.0, 0});
+            continue;
+        case op_t::name: stack.push_back(lookup(module, node)); continue;
+        case op_t::negate:
+            stack.back().fraction = -stack.back().fraction;
+            stack.back().value    = -stack.back().value;
+            continue;
+        default: break;
+        }
+
+        // binary operators, the operands are on top of the stack
+        const auto right = stack.back();
+        stack.pop_back();
+        auto& left = stack.back();
+        switch (node.op) {
+        case op_t::add:
+        case op_t::subtract: {
+            if (left.length != right.length) {
+                fail(module, node.where, "can't mix numbers and lengths");
+            }
+
+            const auto sign = (node.op == op_t::add) ? 1.0 : -1.0;
+            left.fraction += sign * right.fraction;
+            left.value += sign * right.value;
+            break;
+        }
+        case op_t::multiply: {
+            if (left.length && right.length) {
+                fail(module, node.where, "can't multiply lengths");
+            }
+
+            const auto& [length, number] =
+                left.length ? std::pair{left, right} : std::pair{right, left};
+            left = {length.length,
+                    length.fraction * number.value,
+                    length.value * number.value};
+            break;
+        }
+        default:
+            if (right.length) {
+                fail(module, node.where, "can't divide by a length");
+            }
+            if (right.value == 0) {
+                fail(module, node.where, "division by zero");
+            }
+
+            left.fraction /= right.value;
+            left.value /= right.value;
+            break;
+        }
+    }
+    return stack.back();
+}
+
+// lengths without a fraction are plain pixels
+length_t
+sketch_loader_t::length(module_t& module, const expression_ast& expression)
+{
+    const auto result = evaluate(module, expression);
+    if (!result.length) {
+        fail(
+            module,
+            expression.nodes.front().where,
+            "expecting: a length, e.g. 10px or 50%");
+    }
+
+    if (result.fraction == 0) {
+        return {length_t::unit_t::pixels, result.value};
+    }
+    return length_t::fraction(result.fraction, result.value);
+}
+
+std::size_t
+sketch_loader_t::size() const
+{
+    return _modules.size();
+}
+}
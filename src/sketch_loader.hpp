@@ -0,0 +1,99 @@
+#pragma once
+#ifndef SK_IMPL_SKETCH_LOADER_HPP
+#define SK_IMPL_SKETCH_LOADER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <experimental/filesystem>
+#include <iosfwd>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <sketch/geometry.hpp>
+
+#include "error_handler.hpp"
+#include "sketch_ast.hpp"
+
+namespace sk::impl {
+
+/* loads sketches along with the files they include; a loader keeps every
+ * file it has loaded, so a file included by several sketches of a batch is
+ * read and parsed once, and every constant is evaluated once, the first time
+ * it's used
+ */
+class sketch_loader_t final {
+public:
+    // a length is a fraction of the parent plus pixels, e.g. 50% - 20px
+    struct value_t {
+        bool   length   = {false};
+        double fraction = {0};
+        double value    = {0}; // pixels of a length, or the number
+    };
+
+    // a loaded file, kept where it is so that positions into it stay valid
+    struct module_t {
+        enum class state_t : std::uint8_t { unevaluated, evaluating, done };
+
+        struct memo_t {
+            state_t state = {state_t::unevaluated};
+            value_t value;
+        };
+
+        std::string            path; // canonical
+        std::string            source;
+        error_handler_t        errors;
+        file_ast               ast;
+        std::vector<module_t*> includes;
+        bool                   loading = {true}; // includes aren't loaded yet
+
+        std::unordered_map<std::string, std::size_t> names; // definitions
+        std::vector<memo_t>                          memos; // by definition
+
+        module_t(std::string canonical, std::string text, std::ostream& out);
+    };
+
+private:
+    using modules_t = std::map<std::string, std::unique_ptr<module_t>>;
+
+    std::ostream& _diagnostics;
+    modules_t     _modules; // by canonical path
+
+    module_t& load(
+        const std::experimental::filesystem::path& path,
+        module_t*                                  from,
+        const char*                                where);
+
+    std::optional<std::pair<module_t*, std::size_t>>
+            find(module_t& module, const std::string& name);
+    value_t lookup(module_t& module, const expression_ast::node_t& node);
+
+public:
+    explicit sketch_loader_t(std::ostream& diagnostics);
+    ~sketch_loader_t();
+
+    sketch_loader_t(const sketch_loader_t&) = delete;
+    sketch_loader_t& operator=(const sketch_loader_t&) = delete;
+
+    /* loads a sketch and everything it includes, a sketch has to describe a
+     * window; problems are reported along with where they are and then
+     * thrown as std::runtime_error
+     */
+    module_t& load(std::string_view filename);
+
+    // names are looked up in the module first and then in what it includes
+    value_t evaluate(module_t& module, const expression_ast& expression);
+
+    // as evaluate, but the result has to be a length
+    length_t length(module_t& module, const expression_ast& expression);
+
+    std::size_t size() const; // files loaded so far
+};
+}
+
+#endif // SK_IMPL_SKETCH_LOADER_HPP
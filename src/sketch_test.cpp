@@ -1,17 +1,113 @@
+#include <chrono>
 #include <cstdlib>
+#include <fstream>
 #include <iostream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
 
 #include <sketch.hpp>
 
+namespace {
+
+/* capture handlers run on the main thread, the file is written on a worker
+ * so the loop doesn't wait for the disk
+ */
+void
+save(
+    gsl::not_null<sk::window_t*> window,
+    const std::string&           name,
+    sk::capture_t&&              capture)
+{
+    window->spawn([name, data = std::move(capture.data)] {
+        std::ofstream file(name, std::ios::binary);
+        file.write(
+            reinterpret_cast<const char*>(data.data()),
+            static_cast<std::streamsize>(data.size()));
+    });
+}
+}
+
 int
 main(int argc, char** argv)
 {
-    if (argc < 2) {
-        std::cerr << "filename is required\n";
+    // sketches come first, options follow them
+    int options = 1;
+    while (options < argc &&
+           std::string_view(argv[options]).substr(0, 2) != "--") {
+        ++options;
+    }
+
+    // position of the option's argument, zero if the option isn't there
+    const auto option = [&](std::string_view name) {
+        for (int i = options; i + 1 < argc; ++i) {
+            if (std::string_view(argv[i]) == name) {
+                return i + 1;
+            }
+        }
+        return 0;
+    };
+
+    const std::vector<std::string> sketches(argv + 1, argv + options);
+    if (sketches.empty() && !option("--follow")) {
+        std::cerr << "filename is required\n"
+                     "usage: sketch_test <sketch>... [--publish <segment>] "
+                     "[--record <log> | --replay <log> [speed]] "
+                     "[--introspect <socket>] [--capture <directory>]\n"
+                     "       sketch_test --follow <segment> [...]\n";
         return EXIT_FAILURE;
     }
 
-    sk::application_t app;
-    app.add(sk::load_sketch(argv[1]));
+    /* one process of a multi-process wall publishes the sketches, the others
+     * follow it; the publisher follows its own segment as well
+     */
+    sk::application_t                     app;
+    std::optional<sk::layout_publisher_t> publisher;
+    if (const auto segment = option("--publish")) {
+        publisher.emplace(argv[segment]);
+        publisher->publish(sketches);
+        app.follow(argv[segment]);
+    } else if (const auto followed = option("--follow")) {
+        app.follow(argv[followed]);
+    } else {
+        // every second, also headless, e.g. for tests of what gets drawn
+        const auto directory = option("--capture");
+        for (auto& window : sk::load_sketches(sketches)) {
+            const auto handle = app.add(std::move(window));
+            if (!directory) {
+                continue;
+            }
+
+            const auto prefix = std::string(argv[directory]) + "/window" +
+                                std::to_string(handle.index) + "-";
+            app.get(handle)->schedule_every(
+                std::chrono::seconds(1),
+                [prefix, count = 0](gsl::not_null<sk::window_t*> w) mutable {
+                    auto name = prefix + std::to_string(count++) + ".png";
+                    w->capture(
+                        sk::capture_format_t::png,
+                        [name](auto captured, sk::capture_t&& capture) {
+                            save(captured, name, std::move(capture));
+                        });
+                });
+        }
+    }
+
+    // replays can run headless with SDL_VIDEODRIVER=dummy
+    if (const auto log = option("--record")) {
+        app.record(argv[log]);
+    } else if (const auto replayed = option("--replay")) {
+        app.replay(
+            argv[replayed],
+            (argc > replayed + 1) ? std::atof(argv[replayed + 1]) : 1.0);
+    }
+
+    // e.g. echo snapshot | socat - UNIX-CONNECT:<socket>
+    if (const auto socket = option("--introspect")) {
+        app.introspect(argv[socket]);
+    }
+
     return app.run();
 }
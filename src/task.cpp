@@ -0,0 +1,110 @@
+#include <sketch/task.hpp>
+
+#include <array>
+#include <iostream>
+#include <new>
+
+namespace sk::impl {
+
+namespace {
+
+constexpr std::size_t granularity = {64};
+constexpr std::size_t classes     = {16}; // pooled up to 1 KiB
+
+struct free_frame_t {
+    free_frame_t* next;
+};
+
+class frame_pool_t {
+    std::array<free_frame_t*, classes> _free = {};
+
+public:
+    frame_pool_t& operator=(const frame_pool_t&) = delete;
+    frame_pool_t(const frame_pool_t&)            = delete;
+
+    frame_pool_t() = default;
+
+    ~frame_pool_t()
+    {
+        for (auto head : _free) {
+            while (head) {
+                ::operator delete(std::exchange(head, head->next));
+            }
+        }
+    }
+
+    void*
+    allocate(std::size_t size_class)
+    {
+        if (auto frame = _free[size_class]) {
+            _free[size_class] = frame->next;
+            return frame;
+        }
+
+        return ::operator new((size_class + 1) * granularity);
+    }
+
+    void
+    deallocate(void* frame, std::size_t size_class) noexcept
+    {
+        auto node         = static_cast<free_frame_t*>(frame);
+        node->next        = _free[size_class];
+        _free[size_class] = node;
+    }
+};
+
+thread_local frame_pool_t pool;
+
+thread_local std::exception_ptr failure;
+thread_local std::size_t        discarded = {0}; // failures after the first
+
+std::size_t
+size_class(std::size_t size)
+{
+    return (size + granularity - 1) / granularity - 1;
+}
+}
+
+void*
+allocate_frame(std::size_t size)
+{
+    const auto cls = size_class(size);
+    return (cls < classes) ? pool.allocate(cls) : ::operator new(size);
+}
+
+void
+deallocate_frame(void* frame, std::size_t size) noexcept
+{
+    const auto cls = size_class(size);
+    if (cls < classes) {
+        pool.deallocate(frame, cls);
+    } else {
+        ::operator delete(frame);
+    }
+}
+
+void
+fail_task(std::exception_ptr error) noexcept
+{
+    if (!failure) {
+        failure = std::move(error);
+    } else {
+        ++discarded;
+    }
+}
+
+void
+rethrow_failed_task()
+{
+    if (!failure) {
+        return;
+    }
+
+    if (const auto count = std::exchange(discarded, 0)) {
+        std::cerr << "warning: " << count
+                  << " more task failure(s) discarded, rethrowing the first"
+                  << std::endl;
+    }
+    std::rethrow_exception(std::exchange(failure, nullptr));
+}
+}
@@ -0,0 +1,306 @@
+#include "timer_wheel.hpp"
+
+#include <algorithm>
+#include <limits>
+
+namespace sk::impl {
+
+namespace {
+
+using ticks_t = std::chrono::milliseconds;
+}
+
+timer_wheel_t::timer_wheel_t()
+{
+    for (auto& level : _heads) {
+        level.fill(npos);
+    }
+}
+
+std::uint64_t
+timer_wheel_t::to_tick(clock_t::time_point time_point) const
+{
+    if (time_point <= _origin) {
+        return 0;
+    }
+
+    return static_cast<std::uint64_t>(
+        std::chrono::duration_cast<ticks_t>(time_point - _origin).count());
+}
+
+timer_wheel_t::clock_t::time_point
+timer_wheel_t::to_time_point(std::uint64_t tick) const
+{
+    return _origin + ticks_t(static_cast<ticks_t::rep>(tick));
+}
+
+std::uint32_t
+timer_wheel_t::allocate()
+{
+    if (_free != npos) {
+        const auto index = _free;
+        _free              = _nodes[index].next;
+        _nodes[index].next = npos;
+        return index;
+    }
+
+    _nodes.emplace_back();
+    return static_cast<std::uint32_t>(_nodes.size() - 1);
+}
+
+void
+timer_wheel_t::release(std::uint32_t index)
+{
+    auto& node = _nodes[index];
+    if (node.owner) {
+        if (node.owner_prev != npos) {
+            _nodes[node.owner_prev].owner_next = node.owner_next;
+        } else {
+            *node.owner = node.owner_next;
+        }
+
+        if (node.owner_next != npos) {
+            _nodes[node.owner_next].owner_prev = node.owner_prev;
+        }
+
+        node.owner      = nullptr;
+        node.owner_prev = node.owner_next = npos;
+    }
+
+    node.callback = nullptr;
+    node.alive    = false;
+    ++node.generation;
+    node.prev = npos;
+    node.next = _free;
+    _free     = index;
+    --_count;
+}
+
+void
+timer_wheel_t::link(std::uint32_t index)
+{
+    auto&      node  = _nodes[index];
+    const auto delta = node.expires - _current_tick;
+
+    std::size_t   level    = 0;
+    std::uint64_t position = node.expires;
+    while (level < levels - 1 && delta >= (1ull << shift(level + 1))) {
+        ++level;
+    }
+
+    if (delta >= (1ull << shift(levels))) {
+        // beyond the wheel horizon, park it at the farthest slot
+        position = _current_tick + (1ull << shift(levels)) - 1;
+    }
+
+    const auto slot = (position >> shift(level)) & slot_mask;
+    auto&      head = _heads[level][slot];
+
+    node.slot = static_cast<std::uint32_t>(level * slots + slot);
+    node.prev = npos;
+    node.next = head;
+    if (head != npos) {
+        _nodes[head].prev = index;
+    }
+    head = index;
+}
+
+void
+timer_wheel_t::unlink(std::uint32_t index)
+{
+    auto& node = _nodes[index];
+    if (node.prev != npos) {
+        _nodes[node.prev].next = node.next;
+    } else {
+        _heads[node.slot / slots][node.slot % slots] = node.next;
+    }
+
+    if (node.next != npos) {
+        _nodes[node.next].prev = node.prev;
+    }
+
+    node.prev = node.next = node.slot = npos;
+}
+
+void
+timer_wheel_t::cascade(std::size_t level)
+{
+    const auto slot = (_current_tick >> shift(level)) & slot_mask;
+    auto&      head = _heads[level][slot];
+    while (head != npos) {
+        const auto index = head;
+        unlink(index);
+        link(index);
+    }
+}
+
+void
+timer_wheel_t::fire(std::size_t slot)
+{
+    auto& head = _heads[0][slot];
+    while (head != npos) {
+        const auto index = head;
+        unlink(index);
+
+        // the callback is free to schedule or cancel timers, including this
+        // one, so nothing may refer into _nodes across the call
+        auto&      node       = _nodes[index];
+        const auto generation = node.generation;
+        auto       callback   = std::move(node.callback);
+        if (node.period) {
+            node.expires =
+                std::max(node.expires + node.period, _current_tick + 1);
+            link(index);
+        }
+
+        callback();
+
+        auto& fired = _nodes[index];
+        if (fired.generation != generation) {
+            continue; // cancelled from within the callback
+        }
+
+        if (fired.period) {
+            fired.callback = std::move(callback);
+        } else {
+            release(index);
+        }
+    }
+}
+
+std::uint64_t
+timer_wheel_t::schedule(
+    clock_t::duration delay,
+    clock_t::duration period,
+    callback_t&&      callback,
+    std::uint32_t*    owner)
+{
+    const auto index = allocate();
+    auto&      node  = _nodes[index];
+    node.expires     = std::max(
+        to_tick(clock_t::now()) +
+            static_cast<std::uint64_t>(
+                std::chrono::ceil<ticks_t>(delay).count()),
+        _current_tick + 1);
+    node.period = (period > clock_t::duration::zero())
+                      ? std::max<std::uint64_t>(
+                            static_cast<std::uint64_t>(
+                                std::chrono::ceil<ticks_t>(period).count()),
+                            1)
+                      : 0;
+    node.alive    = true;
+    node.callback = std::move(callback);
+    if (owner) {
+        node.owner      = owner;
+        node.owner_next = *owner;
+        if (*owner != npos) {
+            _nodes[*owner].owner_prev = index;
+        }
+        *owner = index;
+    }
+    ++_count;
+    link(index);
+
+    return (static_cast<std::uint64_t>(node.generation) << 32u) | index;
+}
+
+bool
+timer_wheel_t::cancel(std::uint64_t id, const std::uint32_t* owner)
+{
+    const auto index      = static_cast<std::uint32_t>(id & UINT32_MAX);
+    const auto generation = static_cast<std::uint32_t>(id >> 32u);
+    if (index >= _nodes.size() || !_nodes[index].alive ||
+        _nodes[index].generation != generation ||
+        (owner && _nodes[index].owner != owner)) {
+        return false;
+    }
+
+    if (_nodes[index].slot != npos) {
+        unlink(index);
+    }
+
+    release(index);
+    return true;
+}
+
+void
+timer_wheel_t::cancel_all(std::uint32_t& owner)
+{
+    while (owner != npos) {
+        const auto index = owner;
+        if (_nodes[index].slot != npos) {
+            unlink(index);
+        }
+        release(index); // moves the owner head along
+    }
+}
+
+void
+timer_wheel_t::advance(clock_t::time_point now)
+{
+    const auto target = to_tick(now);
+    while (_current_tick < target) {
+        if (!_count) {
+            _current_tick = target;
+            break;
+        }
+
+        ++_current_tick;
+
+        // cascade from the highest level whose slot boundary was crossed down
+        // to level one, so entries settle into their final slots
+        std::size_t level = 0;
+        while (level < levels - 1 &&
+               !(_current_tick & ((1ull << shift(level + 1)) - 1))) {
+            ++level;
+        }
+
+        for (; level > 0; --level) {
+            cascade(level);
+        }
+
+        fire(_current_tick & slot_mask);
+    }
+}
+
+std::size_t
+timer_wheel_t::size() const
+{
+    return _count;
+}
+
+timer_wheel_t::clock_t::time_point
+timer_wheel_t::next_deadline() const
+{
+    if (!_count) {
+        return clock_t::time_point::max();
+    }
+
+    auto deadline = std::numeric_limits<std::uint64_t>::max();
+    for (std::uint64_t offset = 1; offset < slots; ++offset) {
+        if (_heads[0][(_current_tick + offset) & slot_mask] != npos) {
+            deadline = _current_tick + offset;
+            break;
+        }
+    }
+
+    // upper levels only tell when their slot is cascaded, which is early
+    // enough since nothing in a slot expires before that
+    for (std::size_t level = 1; level < levels; ++level) {
+        const auto block = _current_tick >> shift(level);
+        for (std::uint64_t offset = 1; offset <= slots; ++offset) {
+            if (_heads[level][(block + offset) & slot_mask] != npos) {
+                deadline =
+                    std::min(deadline, (block + offset) << shift(level));
+                break;
+            }
+        }
+    }
+
+    if (deadline == std::numeric_limits<std::uint64_t>::max()) {
+        return clock_t::time_point::max();
+    }
+
+    return to_time_point(deadline);
+}
+}
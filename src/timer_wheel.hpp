@@ -0,0 +1,93 @@
+#pragma once
+#ifndef SK_IMPL_TIMER_WHEEL_HPP
+#define SK_IMPL_TIMER_WHEEL_HPP
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace sk::impl {
+
+/* hierarchical timing wheel with millisecond ticks: four levels of 64 slots
+ * each cover ~4.6 hours, longer delays are parked in the last slot of the top
+ * level and re-cascaded; scheduling and cancellation are O(1)
+ *
+ * timers may belong to an owner list, the head of which lives with the owner
+ * and has to stay put while the list is not empty
+ */
+class timer_wheel_t {
+public:
+    using clock_t    = std::chrono::steady_clock;
+    using callback_t = std::function<void()>;
+
+private:
+    static constexpr std::size_t level_bits = {6};
+    static constexpr std::size_t levels     = {4};
+    static constexpr std::size_t slots      = {1u << level_bits};
+    static constexpr std::size_t slot_mask  = {slots - 1};
+
+public:
+    static constexpr std::uint32_t npos = {UINT32_MAX};
+
+private:
+    static constexpr std::uint64_t
+    shift(std::size_t level)
+    {
+        return level_bits * level;
+    }
+
+    struct node_t {
+        std::uint64_t  expires    = {0};
+        std::uint64_t  period     = {0}; // zero for one-shot timers
+        std::uint32_t  generation = {1};
+        std::uint32_t  prev       = {npos};
+        std::uint32_t  next       = {npos};
+        std::uint32_t  slot       = {npos}; // npos while unlinked
+        std::uint32_t  owner_prev = {npos};
+        std::uint32_t  owner_next = {npos};
+        std::uint32_t* owner      = {nullptr};
+        bool           alive     = {false};
+        callback_t     callback;
+    };
+
+    std::vector<node_t>                                  _nodes;
+    std::array<std::array<std::uint32_t, slots>, levels> _heads;
+    std::uint32_t                                        _free  = {npos};
+    std::size_t                                          _count = {0};
+    std::uint64_t                                        _current_tick = {0};
+    clock_t::time_point _origin = {clock_t::now()};
+
+    std::uint64_t       to_tick(clock_t::time_point) const;
+    clock_t::time_point to_time_point(std::uint64_t tick) const;
+    std::uint32_t       allocate();
+    void                release(std::uint32_t);
+    void                link(std::uint32_t);
+    void                unlink(std::uint32_t);
+    void                cascade(std::size_t level);
+    void                fire(std::size_t slot);
+
+public:
+    timer_wheel_t();
+
+    std::uint64_t schedule(
+        clock_t::duration delay,
+        clock_t::duration period,
+        callback_t&&      callback,
+        std::uint32_t*    owner = nullptr);
+
+    // with an owner, only a timer on that owner list is cancelled
+    bool cancel(std::uint64_t id, const std::uint32_t* owner = nullptr);
+    void cancel_all(std::uint32_t& owner);
+
+    void        advance(clock_t::time_point now = clock_t::now());
+    std::size_t size() const;
+
+    // earliest point in time the wheel needs attention, never later than the
+    // first expiration
+    clock_t::time_point next_deadline() const;
+};
+}
+
+#endif // SK_IMPL_TIMER_WHEEL_HPP
@@ -1,39 +1,172 @@
 #include <sketch/window.hpp>
 
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+
 #include <SDL.h>
 
 #include <sketch/application.hpp>
 
+#include "job_system.hpp"
+#include "layout_engine.hpp"
+#include "sdl2_display.hpp"
+#include "timer_wheel.hpp"
+
+using namespace std::chrono_literals;
+
 namespace sk {
 
-window_t::window_t(
-    std::string_view title,
+namespace {
+
+// positions left to the system by the layout stay where they are
+int
+to_sdl_position(int position, int display)
+{
+    return (position == impl::layout_engine_t::unset)
+               ? static_cast<int>(
+                     SDL_WINDOWPOS_UNDEFINED_DISPLAY(std::max(display, 0)))
+               : position;
+}
+
+SDL_Window*
+create_window(std::string_view title, const geometry_t& geometry)
+{
+    const auto rect = impl::layout_engine_t::resolve(
+        geometry, impl::sdl2::display::get_rect(geometry.display));
+    return SDL_CreateWindow(
+        title.data(),
+        to_sdl_position(rect.x, geometry.display),
+        to_sdl_position(rect.y, geometry.display),
+        rect.w,
+        rect.h,
+        SDL_WINDOW_SHOWN);
+}
+
+geometry_t
+from_boundaries(
     const std::tuple<std::size_t, std::size_t, std::size_t, std::size_t>&
         boundaries)
+{
+    const auto display = impl::sdl2::display::get_rect();
+    const auto offset  = [](std::size_t value, int origin) {
+        return length_t{length_t::unit_t::pixels,
+                        static_cast<double>(value) - origin};
+    };
+
+    return {offset(std::get<0>(boundaries), display.x),
+            offset(std::get<1>(boundaries), display.y),
+            length_t::pixels(std::get<2>(boundaries)),
+            length_t::pixels(std::get<3>(boundaries))};
+}
+}
+
+window_t::window_t(std::string_view title, const geometry_t& geometry)
     : _window(
-          SDL_CreateWindow(
-              title.data(),
-              static_cast<int>(std::get<0>(boundaries)), // x
-              static_cast<int>(std::get<1>(boundaries)), // y
-              static_cast<int>(std::get<2>(boundaries)), // w
-              static_cast<int>(std::get<3>(boundaries)), // h
-              SDL_WINDOW_SHOWN),
-          [](SDL_Window* ptr) { SDL_DestroyWindow(ptr); })
+          create_window(title, geometry),
+          [](SDL_Window* ptr) { SDL_DestroyWindow(ptr); }),
+      _title(title),
+      _geometry(geometry),
+      _canvas(_window.get())
 {
     if (!_window) {
         throw std::runtime_error(SDL_GetError());
     }
 
-    _reactor._window = this;
+    _id = SDL_GetWindowID(_window.get());
+
+    int width = 0, height = 0;
+    SDL_GetWindowSize(_window.get(), &width, &height);
+    _scene.resize(width, height);
+
+    _reactor._window  = this;
+    _keyboard._window = this;
 }
 
-window_t::~window_t() = default;
+window_t::window_t(
+    std::string_view title,
+    const std::tuple<std::size_t, std::size_t, std::size_t, std::size_t>&
+        boundaries)
+    : window_t(title, from_boundaries(boundaries))
+{
+}
+
+window_t::window_t(window_t&& other) noexcept
+    : _window(std::move(other._window)),
+      _title(std::move(other._title)),
+      _geometry(other._geometry),
+      _scene(std::move(other._scene)),
+      _canvas(std::move(other._canvas)),
+      _reactor(std::move(other._reactor)),
+      _keyboard(std::move(other._keyboard)),
+      _app(std::exchange(other._app, nullptr)),
+      _handle(std::exchange(other._handle, {})),
+      _id(std::exchange(other._id, 0)),
+      _hovered(other._hovered),
+      _frame_interval(other._frame_interval),
+      _frame_epoch(other._frame_epoch),
+      _throttled(other._throttled),
+      _key_waiters(std::move(other._key_waiters)),
+      _mouse_move_waiters(std::move(other._mouse_move_waiters)),
+      _frame_waiters(std::move(other._frame_waiters)),
+      _sleepers(std::move(other._sleepers))
+{
+    // timers call the window they were scheduled on, they don't move along
+    if (_app) {
+        _app->_timers->cancel_all(other._timer_list);
+    }
+    _reactor._window  = this;
+    _keyboard._window = this;
+}
+
+window_t&
+window_t::operator=(window_t&& other) noexcept
+{
+    // timers call the window they were scheduled on, they don't move along
+    if (_app) {
+        _app->_timers->cancel_all(_timer_list);
+    }
+    if (other._app) {
+        other._app->_timers->cancel_all(other._timer_list);
+    }
+    _window             = std::move(other._window);
+    _title              = std::move(other._title);
+    _geometry           = other._geometry;
+    _scene              = std::move(other._scene);
+    _canvas             = std::move(other._canvas);
+    _reactor            = std::move(other._reactor);
+    _keyboard           = std::move(other._keyboard);
+    _app                = std::exchange(other._app, nullptr);
+    _handle             = std::exchange(other._handle, {});
+    _id                 = std::exchange(other._id, 0);
+    _hovered            = other._hovered;
+    _frame_interval     = other._frame_interval;
+    _frame_epoch        = other._frame_epoch;
+    _throttled          = other._throttled;
+    _key_waiters        = std::move(other._key_waiters);
+    _mouse_move_waiters = std::move(other._mouse_move_waiters);
+    _frame_waiters      = std::move(other._frame_waiters);
+    _sleepers           = std::move(other._sleepers);
+    _reactor._window    = this;
+    _keyboard._window   = this;
+    return *this;
+}
+
+window_t::~window_t()
+{
+    // sleeping coroutines are destroyed along with their list, their timers
+    // are among the owned ones
+    if (_app) {
+        _app->_timers->cancel_all(_timer_list);
+    }
+}
 
 window_t::operator SDL_Window*() { return _window.get(); }
 void
 window_t::reactor(reactor_t&& reactor)
 {
-    _reactor = std::move(reactor);
+    _reactor         = std::move(reactor);
+    _reactor._window = this;
 }
 
 reactor_t&
@@ -48,4 +181,213 @@ window_t::quit()
     assert(_app);
     _app->quit();
 }
+
+void
+window_t::close()
+{
+    assert(_app);
+    _app->remove(_handle);
+}
+
+std::string_view
+window_t::title() const
+{
+    return _title;
+}
+
+window_handle_t
+window_t::handle() const
+{
+    return _handle;
+}
+
+const geometry_t&
+window_t::geometry() const
+{
+    return _geometry;
+}
+
+void
+window_t::geometry(const geometry_t& geometry)
+{
+    _geometry = geometry;
+    if (_app) {
+        _app->constrain(*this);
+        return;
+    }
+
+    // not laid out by an application yet, applied right away
+    const auto rect = impl::layout_engine_t::resolve(
+        geometry, impl::sdl2::display::get_rect(geometry.display));
+    place(rect.x, rect.y, rect.w, rect.h);
+}
+
+scene_t&
+window_t::scene()
+{
+    return _scene;
+}
+
+const scene_t&
+window_t::scene() const
+{
+    return _scene;
+}
+
+canvas_t&
+window_t::canvas()
+{
+    return _canvas;
+}
+
+keyboard_t&
+window_t::keyboard()
+{
+    return _keyboard;
+}
+
+const keyboard_t&
+window_t::keyboard() const
+{
+    return _keyboard;
+}
+
+void
+window_t::place(int x, int y, int w, int h)
+{
+    SDL_SetWindowSize(_window.get(), w, h);
+    SDL_SetWindowPosition(
+        _window.get(),
+        to_sdl_position(x, _geometry.display),
+        to_sdl_position(y, _geometry.display));
+}
+
+timer_id_t
+window_t::schedule(
+    std::chrono::milliseconds                       delay,
+    std::chrono::milliseconds                       period,
+    std::function<void(gsl::not_null<window_t*>)>&& func)
+{
+    if (!_app) {
+        throw std::logic_error("window is not added to an application");
+    }
+
+    return _app->_timers->schedule(
+        delay,
+        period,
+        [this, func = std::move(func)] { func(this); },
+        &_timer_list);
+}
+
+bool
+window_t::cancel(timer_id_t id)
+{
+    // only its own timers, not those of other windows or the application
+    return _app && _app->_timers->cancel(id, &_timer_list);
+}
+
+void
+window_t::submit(std::function<void()>&& job)
+{
+    if (!_app) {
+        throw std::logic_error("window is not added to an application");
+    }
+
+    _app->jobs().submit(std::move(job));
+}
+
+bool
+window_t::request_capture(capture_format_t format, capture_handler_t&& func)
+{
+    if (!_app) {
+        throw std::logic_error("window is not added to an application");
+    }
+
+    return _app->capture(*this, format, std::move(func));
+}
+
+std::function<void(window_t::continuation_t&&)>
+window_t::poster()
+{
+    if (!_app) {
+        throw std::logic_error("window is not added to an application");
+    }
+
+    return [app = _app, jobs = &_app->jobs(), handle = _handle](
+               continuation_t&& continuation) {
+        jobs->post([app, handle, continuation = std::move(continuation)] {
+            if (auto window = app->get(handle)) {
+                continuation(window);
+            }
+        });
+    };
+}
+
+void
+window_t::sleep(sleep_awaiter_t& sleeper)
+{
+    if (!_app) {
+        throw std::logic_error("window is not added to an application");
+    }
+
+    _sleepers.push_back(sleeper);
+    _app->_timers->schedule(
+        sleeper._delay,
+        std::chrono::milliseconds::zero(),
+        [this, &sleeper] {
+            _sleepers.erase(sleeper);
+            sleeper.handle.resume();
+        },
+        &_timer_list);
+}
+
+void
+window_t::frame_rate(std::size_t fps)
+{
+    if (!fps) {
+        throw std::invalid_argument("frame rate must be positive");
+    }
+
+    // a zero interval would keep the frame scheduler from ever moving on
+    const auto interval = std::chrono::nanoseconds(1s) / fps;
+    if (interval == std::chrono::nanoseconds::zero()) {
+        throw std::invalid_argument("frame rate must be at most 1e9");
+    }
+
+    _frame_interval = interval;
+    if (_app) {
+        _app->schedule_frame(*this, _frame_interval);
+    }
+}
+
+std::size_t
+window_t::frame_rate() const
+{
+    return static_cast<std::size_t>(std::chrono::nanoseconds(1s) /
+                                    _frame_interval);
+}
+
+window_t::key_awaiter_t
+window_t::next_key()
+{
+    return key_awaiter_t(_key_waiters);
+}
+
+window_t::mouse_move_awaiter_t
+window_t::next_mouse_move()
+{
+    return mouse_move_awaiter_t(_mouse_move_waiters);
+}
+
+window_t::frame_awaiter_t
+window_t::next_frame()
+{
+    return frame_awaiter_t(_frame_waiters);
+}
+
+window_t::sleep_awaiter_t
+window_t::sleep_for(std::chrono::milliseconds delay)
+{
+    return {*this, delay};
+}
 }
@@ -0,0 +1,136 @@
+#include "window_registry.hpp"
+
+namespace sk::impl {
+
+window_handle_t
+window_registry_t::insert(
+    std::unique_ptr<window_t> window, std::uint32_t id, std::string title)
+{
+    std::uint32_t index = _free;
+    if (index != npos) {
+        _free = _slots[index].dense;
+    } else {
+        index = static_cast<std::uint32_t>(_slots.size());
+        _slots.emplace_back();
+    }
+
+    auto& slot  = _slots[index];
+    slot.window = std::move(window);
+    slot.title  = std::move(title);
+    slot.id     = id;
+    slot.dense  = static_cast<std::uint32_t>(_dense.size());
+    _dense.push_back(slot.window.get());
+    _dense_slots.push_back(index);
+
+    _by_id[id] = index;
+
+    // titles aren't required to be unique, the latest window wins
+    const auto [newest, added] = _by_title.try_emplace(slot.title, index);
+    slot.older                 = added ? npos : newest->second;
+    slot.newer                 = npos;
+    if (!added) {
+        _slots[newest->second].newer = index;
+        newest->second               = index;
+    }
+
+    return {index, slot.generation};
+}
+
+std::unique_ptr<window_t>
+window_registry_t::erase(window_handle_t handle)
+{
+    if (!get(handle)) {
+        return nullptr;
+    }
+
+    auto& slot = _slots[handle.index];
+
+    // swap the last live window into the vacated position
+    const auto position    = slot.dense;
+    _dense[position]       = _dense.back();
+    _dense_slots[position] = _dense_slots.back();
+    _slots[_dense_slots[position]].dense = position;
+    _dense.pop_back();
+    _dense_slots.pop_back();
+
+    _by_id.erase(slot.id);
+    // an older window with the same title takes over if this one was newest
+    if (slot.older != npos) {
+        _slots[slot.older].newer = slot.newer;
+    }
+    if (slot.newer != npos) {
+        _slots[slot.newer].older = slot.older;
+    } else if (slot.older != npos) {
+        _by_title.find(slot.title)->second = slot.older;
+    } else {
+        _by_title.erase(_by_title.find(slot.title));
+    }
+    slot.older = slot.newer = npos;
+
+    auto window = std::move(slot.window);
+    slot.title.clear();
+    ++slot.generation;
+    slot.dense = _free;
+    _free      = handle.index;
+
+    return window;
+}
+
+window_t*
+window_registry_t::get(window_handle_t handle) const
+{
+    if (handle.index >= _slots.size()) {
+        return nullptr;
+    }
+
+    const auto& slot = _slots[handle.index];
+    return (slot.generation == handle.generation) ? slot.window.get()
+                                                  : nullptr;
+}
+
+window_t*
+window_registry_t::find(std::uint32_t id) const
+{
+    const auto found = _by_id.find(id);
+    return (found != _by_id.end()) ? _slots[found->second].window.get()
+                                   : nullptr;
+}
+
+window_t*
+window_registry_t::find(std::string_view title) const
+{
+    const auto found = _by_title.find(title);
+    return (found != _by_title.end()) ? _slots[found->second].window.get()
+                                      : nullptr;
+}
+
+window_t*
+window_registry_t::at_slot(std::uint32_t index) const
+{
+    return (index < _slots.size()) ? _slots[index].window.get() : nullptr;
+}
+
+std::size_t
+window_registry_t::size() const
+{
+    return _dense.size();
+}
+
+std::vector<window_t*>::const_iterator
+window_registry_t::begin() const
+{
+    return _dense.cbegin();
+}
+
+std::vector<window_t*>::const_iterator
+window_registry_t::end() const
+{
+    return _dense.cend();
+}
+
+window_t*
+window_registry_t::operator[](std::size_t position) const
+{
+    return _dense[position];
+}
+}
@@ -0,0 +1,84 @@
+#pragma once
+#ifndef SK_IMPL_WINDOW_REGISTRY_HPP
+#define SK_IMPL_WINDOW_REGISTRY_HPP
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <sketch/window.hpp>
+
+namespace sk::impl {
+
+/* slot map of windows: every window is allocated on its own so its address
+ * never changes, handles carry the slot generation so they never resolve to
+ * a window that took over a freed slot; live windows are also kept densely
+ * packed for iteration, and can be looked up by SDL window id and by title
+ */
+class window_registry_t {
+    static constexpr std::uint32_t npos = {UINT32_MAX};
+
+    struct string_hash_t {
+        using is_transparent = void;
+
+        std::size_t
+        operator()(std::string_view str) const
+        {
+            return std::hash<std::string_view>()(str);
+        }
+    };
+
+    struct slot_t {
+        std::unique_ptr<window_t> window;
+        std::string               title;
+        std::uint32_t             id         = {0};
+        std::uint32_t             generation = {0};
+        std::uint32_t             dense      = {npos}; // next free if empty
+
+        // neighbours among the windows with the same title
+        std::uint32_t older = {npos};
+        std::uint32_t newer = {npos};
+    };
+
+    std::vector<slot_t>        _slots;
+    std::uint32_t              _free = {npos};
+    std::vector<window_t*>     _dense;
+    std::vector<std::uint32_t> _dense_slots;
+
+    std::unordered_map<std::uint32_t, std::uint32_t> _by_id;
+    // slot of the newest window with a title, linked to the older ones
+    std::unordered_map<
+        std::string,
+        std::uint32_t,
+        string_hash_t,
+        std::equal_to<>>
+        _by_title;
+
+public:
+    window_handle_t insert(
+        std::unique_ptr<window_t> window, std::uint32_t id, std::string title);
+
+    // hands the window over to the caller, its handle is stale from now on
+    std::unique_ptr<window_t> erase(window_handle_t);
+
+    window_t* get(window_handle_t) const;
+    window_t* find(std::uint32_t id) const;
+    // the newest of the windows with that title
+    window_t* find(std::string_view title) const;
+
+    // window in the slot with the given index, whatever its generation
+    window_t* at_slot(std::uint32_t index) const;
+
+    std::size_t size() const;
+
+    // live windows, invalidated by insert and erase
+    std::vector<window_t*>::const_iterator begin() const;
+    std::vector<window_t*>::const_iterator end() const;
+    window_t* operator[](std::size_t position) const;
+};
+}
+
+#endif // SK_IMPL_WINDOW_REGISTRY_HPP